@@ -10,9 +10,31 @@
  **/
 
 #include "ArenaGrid.h"
+#include "BaseUnit.h"
+#include "DamageQueueSubsystem.h"
+#include "UnitPoolSubsystem.h"
+#include "PlayerRegistrySubsystem.h"
+#include "WaveDirectorComponent.h"
+#include "EngineUtils.h"
+#include "Components/ShapeComponent.h"
 
 #define ModifierIDs FSaveState::ModifierIDs
 
+AArenaGrid* AArenaGrid::FindArena(const UObject* worldContextObject)
+{
+	UWorld* world = worldContextObject ? worldContextObject->GetWorld() : nullptr;
+	if (!world)
+		return nullptr;
+
+	// There is only ever one arena in a level
+	for (TActorIterator<AArenaGrid> iter(world); iter; ++iter)
+	{
+		return *iter;
+	}
+
+	return nullptr;
+}
+
 // Sets default values
 AArenaGrid::AArenaGrid()
 {
@@ -24,6 +46,40 @@ AArenaGrid::AArenaGrid()
 	Padding = 1.0f;
 	MinHeight = 0.0f;
 	MaxHeight = 1500.0f;
+	TileSurfaceHeight = 1500.0f;
+
+	// Initialize the layout until a floor is spawned
+	mLayoutOrigin = FVector::ZeroVector;
+	mLayoutSize = 1.0f;
+	mLayoutRadius = 0;
+
+	// Initialize influence settings
+	InfluenceSpreadRings = 2;
+	InfluenceHalfLife = 2.0f;
+	PlayerThreatStrength = 1.0f;
+	AllyStrength = 1.0f;
+	ToxicHazardStrength = 1.0f;
+
+	// Initialize tile effect settings
+	UseNativeTileEffects = false;
+	TileEffectsAffectEnemies = false;
+	TileEffectInterval = 0.5f;
+	HealTopperAmountProperty = TEXT("HealAmount");
+	ToxicTopperDamageProperty = TEXT("Damage");
+	TopperEffectPeriod = 1.0f;
+	mTileEffectTimer = 0.0f;
+
+	FlowFieldInterval = 0.5f;
+	mFlowFieldTimer = 0.0f;
+
+	VisibilityEyeHeight = 150.0f;
+	VisibilityPairsPerFrame = 4096;
+
+	AutoSettleDelay = 2.0f;
+	mIsSettled = false;
+	mSettleTimer = AutoSettleDelay;
+
+	WaveDirector = CreateDefaultSubobject<UWaveDirectorComponent>(TEXT("WaveDirector"));
 
 	// Seed the random stream
 	mRand = FRandomStream();
@@ -86,6 +142,12 @@ void AArenaGrid::SpawnFloor(FVector origin, int radius, float padding)
 	}
 
 	CalculateRing(center, radius);
+
+	// Cache the layout for tile queries
+	BuildTileLookup(origin, radius, padding);
+
+	// The new floor pieces replicate until the layout settles again
+	WakeArena();
 }
 
 void AArenaGrid::ClearFloor()
@@ -104,6 +166,22 @@ void AArenaGrid::ClearFloor()
 	// Clear FloorPieces and Cells arrays
 	FloorPieces.Empty();
 	Cells.Empty();
+
+	// Clear the cached layout
+	mTileLookup.Empty();
+	mTileCoords.Empty();
+	InfluenceMap.Init(nullptr, 0);
+	TileEffects.Init(0);
+	FlowField.Reset();
+	Visibility.Reset();
+
+	// Tracked units are no longer standing on any tile
+	Occupancy.ResetTiles(0);
+	for (int handle = 0; handle < Occupancy.GetMaxHandle(); handle++)
+	{
+		if (ABaseUnit* unit = Occupancy.GetUnit(handle))
+			unit->mCurrentTile = INDEX_NONE;
+	}
 }
 
 void AArenaGrid::InitHexGrid(int radius)
@@ -120,11 +198,14 @@ void AArenaGrid::InitHexGrid(int radius)
 
 void AArenaGrid::StartRound()
 {
+	WakeArena();
 	CalculateTilePositions();
 }
 
 void AArenaGrid::EndRound()
 {
+	WakeArena();
+
 	// Reset the center tile to it's max height
 	FloorPieces[0]->SetActorLocation(FVector(FloorPieces[0]->GetActorLocation().X, FloorPieces[0]->GetActorLocation().Y, MaxHeight));
 
@@ -141,6 +222,8 @@ void AArenaGrid::EndRound()
 
 void AArenaGrid::SetupLobbyOrientation(int numTiles)
 {
+	WakeArena();
+
 	for (int i = 0; i < numTiles; i++)
 	{
 		FloorPieces[i]->SetActorLocation(FVector(FloorPieces[i]->GetActorLocation().X, FloorPieces[i]->GetActorLocation().Y, -MaxHeight));
@@ -179,6 +262,8 @@ int AArenaGrid::SaveState(int index, bool freshState)
 
 void AArenaGrid::GenerateArena(float scale)
 {
+	WakeArena();
+
 	scale *= 0.001;
 	CalculateTilePositions(scale);
 	CalculateTileModifiers();
@@ -264,6 +349,9 @@ FSaveState AArenaGrid::EditorLoadSaveState(int index, FVector origin, int radius
 		}
 
 		CalculateRing(center, radius);
+
+		// Cache the layout for tile queries
+		BuildTileLookup(origin, radius, padding);
 	}
 	// If an invalid index is entered generate the default arena
 	else
@@ -316,6 +404,11 @@ void AArenaGrid::LoadModifiers(UPARAM(ref) FSaveState cur)
 		{
 		case ModifierIDs::HEAL_TOPPER:		// Spawn Healing topper
 		{
+			// The grid only takes over if it can find how much the topper heals
+			float healRate = GetTopperRate(healTopper, HealTopperAmountProperty);
+			if (healRate > 0.0f)
+				TileEffects.AddEffect(FTileEffect(i, healRate, 0.0f, 0.0f));
+
 			// Init spawn parameters
 			FActorSpawnParameters spawnParams;
 			spawnParams.Owner = this;
@@ -332,6 +425,10 @@ void AArenaGrid::LoadModifiers(UPARAM(ref) FSaveState cur)
 				FRotator rot = this->GetActorRotation();
 				AActor* topper = GetWorld()->SpawnActor<AActor>(healTopper, loc, rot, spawnParams);
 
+				// The grid heals units on this tile, the topper's own effect volume isn't needed
+				if (healRate > 0.0f)
+					DisableEffectVolume(topper);
+
 				// Child new floor piece to the grid object
 				FAttachmentTransformRules attachRules = FAttachmentTransformRules::KeepWorldTransform;
 				topper->AttachToActor(this, attachRules);
@@ -387,6 +484,12 @@ void AArenaGrid::LoadModifiers(UPARAM(ref) FSaveState cur)
 			FVector loc = FloorPieces[i]->GetActorLocation();										// Like the other one this needs to be revised to deal with the movement issue
 			loc.Z = FloorHeights[i] + 1500.0f;	// Find a programmatic way to determine this
 
+			// Toxic tiles are hazardous whether or not the topper actor is set
+			InfluenceMap.AddSource(HAZARD, i, ToxicHazardStrength);
+			float toxicRate = GetTopperRate(toxicTopper, ToxicTopperDamageProperty);
+			if (toxicRate > 0.0f)
+				TileEffects.AddEffect(FTileEffect(i, 0.0f, toxicRate, 0.0f));
+
 			// Check if actor to spawn is valid
 			if (toxicTopper)
 			{
@@ -394,6 +497,10 @@ void AArenaGrid::LoadModifiers(UPARAM(ref) FSaveState cur)
 				FRotator rot = this->GetActorRotation();
 				AActor* topper = GetWorld()->SpawnActor<AActor>(toxicTopper, loc, rot, spawnParams);
 
+				// The grid damages units on this tile, the topper's own effect volume isn't needed
+				if (toxicRate > 0.0f)
+					DisableEffectVolume(topper);
+
 				// Child new floor piece to the grid object
 				FAttachmentTransformRules attachRules = FAttachmentTransformRules::KeepWorldTransform;
 				topper->AttachToActor(this, attachRules);
@@ -422,8 +529,8 @@ void AArenaGrid::LoadModifiers(UPARAM(ref) FSaveState cur)
 			// Check if actor to spawn is valid
 			if (Gladiator)
 			{
-				// Spawn new enemy
-				AActor* enemy = GetWorld()->SpawnActor<AActor>(Gladiator, loc, rot, spawnParams);
+				// Spawn new enemy, reusing a pooled one if there is one
+				AActor* enemy = SpawnEnemy(Gladiator, loc, rot, spawnParams);
 
 				// Child new enemy to the grid object
 				FAttachmentTransformRules attachRules = FAttachmentTransformRules::KeepWorldTransform;
@@ -436,29 +543,11 @@ void AArenaGrid::LoadModifiers(UPARAM(ref) FSaveState cur)
 		}
 		case ModifierIDs::GRUNT:	// Spawn grunts
 		{
-			// Init spawn parameters
-			FActorSpawnParameters spawnParams;
-			spawnParams.Owner = this;
-			spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
-
-			// Set spawn transform
-			FVector loc = FloorPieces[i]->GetActorLocation();
-			loc.Z = FloorHeights[i] + 1510.0f;	// Find a programmatic way to determine this
-			FRotator rot = this->GetActorRotation();
-
-			// Check if actor to spawn is valid
-			if (Grunt)
-			{
-				// Spawn new enemy
-				AActor* enemy = GetWorld()->SpawnActor<AActor>(Grunt, loc, rot, spawnParams);
-
-				// Child new enemy to the grid object
-				FAttachmentTransformRules attachRules = FAttachmentTransformRules::KeepWorldTransform;
-				enemy->AttachToActor(this, attachRules);
-
-				// Add the enemy to the array
-				Enemies.Add(enemy);
-			}
+			// The wave director trickles these in over the round instead of spawning them all at once
+			if (WaveDirector && WaveDirector->SpreadModifierGrunts)
+				WaveDirector->QueueSpawns(1);
+			else
+				SpawnGrunt(i);
 			break;
 		}
 		default:
@@ -466,15 +555,54 @@ void AArenaGrid::LoadModifiers(UPARAM(ref) FSaveState cur)
 		}
 	}
 
-	
+	// The new toppers replicate until the layout settles again
+	WakeArena();
+}
+
+AActor* AArenaGrid::SpawnGrunt(int tile)
+{
+	if (!Grunt || !FloorPieces.IsValidIndex(tile) || !FloorPieces[tile])
+		return nullptr;
+
+	// Init spawn parameters
+	FActorSpawnParameters spawnParams;
+	spawnParams.Owner = this;
+	spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	// Set spawn transform just above the tile's surface
+	FVector loc = GetTileCenter(tile);
+	loc.Z += 10.0f;
+	FRotator rot = this->GetActorRotation();
+
+	// Spawn new enemy, reusing a pooled one if there is one
+	AActor* enemy = SpawnEnemy(Grunt, loc, rot, spawnParams);
+	if (!enemy)
+		return nullptr;
+
+	// Child new enemy to the grid object
+	FAttachmentTransformRules attachRules = FAttachmentTransformRules::KeepWorldTransform;
+	enemy->AttachToActor(this, attachRules);
+
+	// Add the enemy to the array, pooled grunts reused during a round are already in it
+	Enemies.AddUnique(enemy);
+	return enemy;
 }
 
 void AArenaGrid::ClearTheBoard()
 {
+	// Grunts still waiting to spawn belong to the level being cleared
+	if (WaveDirector)
+		WaveDirector->Reset();
+
 	// Clear any remaining data from the previous level
+	UUnitPoolSubsystem* pool = UUnitPoolSubsystem::Get(this);
 	for (AActor* iter : Enemies)
 	{
-		if(IsValid(iter))
+		// Units go back to the pool for the next level, anything else is destroyed
+		ABaseUnit* unit = Cast<ABaseUnit>(iter);
+		if (pool && IsValid(unit))
+			pool->ReleaseUnit(unit);
+		else if(IsValid(iter))
 			iter->Destroy();
 	}
 	for (AActor* iter : Toppers)
@@ -489,6 +617,77 @@ void AArenaGrid::ClearTheBoard()
 	Toppers.Empty();
 	FloorHeights.Empty();
 	NavLinks.Empty();
+
+	// The toxic toppers are gone so are their hazards and effects
+	InfluenceMap.ResetLayer(HAZARD);
+	TileEffects.Reset();
+
+	// The floor is about to be rearranged for the next level
+	WakeArena();
+}
+
+void AArenaGrid::SettleArena()
+{
+	if (!HasAuthority())
+		return;
+
+	// Each actor sends its last changes before its channel goes dormant
+	ForEachLayoutActor([](AActor* actor)
+	{
+		actor->SetNetDormancy(DORM_DormantAll);
+	});
+
+	mIsSettled = true;
+}
+
+void AArenaGrid::WakeArena()
+{
+	if (!HasAuthority())
+		return;
+
+	// Waking an arena that is already awake only pushes back when it settles
+	mSettleTimer = AutoSettleDelay;
+	if (!mIsSettled)
+		return;
+
+	// Waking a dormant actor flushes it, so the whole layout is replicated again on the next net tick
+	ForEachLayoutActor([](AActor* actor)
+	{
+		actor->SetNetDormancy(DORM_Awake);
+	});
+
+	mIsSettled = false;
+}
+
+void AArenaGrid::UpdateNetDormancy(float deltaTime)
+{
+	if (AutoSettleDelay <= 0.0f)
+	{
+		if (mIsSettled)
+			WakeArena();
+		return;
+	}
+
+	if (mIsSettled)
+		return;
+
+	mSettleTimer -= deltaTime;
+	if (mSettleTimer <= 0.0f)
+		SettleArena();
+}
+
+void AArenaGrid::SetTileHeight(int tile, float height)
+{
+	if (!FloorPieces.IsValidIndex(tile) || !IsValid(FloorPieces[tile]))
+		return;
+
+	WakeArena();
+
+	FVector location = FloorPieces[tile]->GetActorLocation();
+	FloorPieces[tile]->SetActorLocation(FVector(location.X, location.Y, height));
+
+	if (FloorHeights.IsValidIndex(tile))
+		FloorHeights[tile] = height;
 }
 
 // Called when the game starts or when spawned
@@ -640,11 +839,461 @@ void AArenaGrid::CalculateRing(HexCell center, int radius)
 
 }
 
+void AArenaGrid::BuildTileLookup(FVector origin, int radius, float padding)
+{
+	// Tiles are spawned at padding * padding times their hex-to-pixel offset (see SpawnFloor)
+	mLayoutOrigin = origin;
+	mLayoutSize = FMath::Max(padding * padding, KINDA_SMALL_NUMBER);
+	mLayoutRadius = radius;
+
+	// Every valid Axial coordinate fits inside a (2 * radius + 1) square
+	int width = 2 * radius + 1;
+	mTileLookup.Init(INDEX_NONE, width * width);
+	mTileCoords.Empty(FloorPieces.Num());
+
+	// Cells line up with FloorPieces, any extra cells past the floor pieces are ignored
+	for (int i = 0; i < FloorPieces.Num() && i < Cells.Num(); i++)
+	{
+		int q = Cells[i].GetQ();
+		int r = Cells[i].GetR();
+
+		mTileCoords.Add(FIntPoint(q, r));
+		mTileLookup[(q + radius) * width + (r + radius)] = i;
+	}
+
+	// Rebuild the occupancy index and influence map for the new layout and put every unit back on it
+	InfluenceMap.Init(this, InfluenceSpreadRings);
+	TileEffects.Init(mTileCoords.Num());
+	Occupancy.ResetTiles(mTileCoords.Num());
+	for (int handle = 0; handle < Occupancy.GetMaxHandle(); handle++)
+	{
+		ABaseUnit* unit = Occupancy.GetUnit(handle);
+		if (!unit)
+			continue;
+
+		EInfluenceLayer layer;
+		float strength = GetUnitInfluence(unit, layer);
+
+		unit->mCurrentTile = GetTileAtLocation(unit->GetActorLocation());
+		Occupancy.MoveUnit(handle, unit->mCurrentTile);
+		InfluenceMap.AddSource(layer, unit->mCurrentTile, strength);
+	}
+}
+
+int AArenaGrid::GetTileAtAxial(int q, int r) const
+{
+	// Reject anything outside of the hexagon
+	int s = -q - r;
+	if (FMath::Abs(q) > mLayoutRadius || FMath::Abs(r) > mLayoutRadius || FMath::Abs(s) > mLayoutRadius || mTileLookup.Num() == 0)
+		return INDEX_NONE;
+
+	int width = 2 * mLayoutRadius + 1;
+	return mTileLookup[(q + mLayoutRadius) * width + (r + mLayoutRadius)];
+}
+
+int AArenaGrid::GetTileAtLocation(FVector location) const
+{
+	// Convert the location into fractional Axial coordinates. See https://www.redblobgames.com/grids/hexagons/ (Pixel to hex section)
+	FVector local = (location - mLayoutOrigin) / mLayoutSize;
+	float q = FMath::Sqrt(3.0f) / 3.0f * local.X - 1.0f / 3.0f * local.Y;
+	float r = 2.0f / 3.0f * local.Y;
+
+	HexCell cell = HexRound(q, r, -q - r);
+	return GetTileAtAxial(cell.GetQ(), cell.GetR());
+}
+
+FVector AArenaGrid::GetTileCenter(int tile) const
+{
+	if (!FloorPieces.IsValidIndex(tile) || !FloorPieces[tile])
+		return GetActorLocation();
+
+	FVector center = FloorPieces[tile]->GetActorLocation();
+	center.Z = GetTileSurfaceHeight(tile);
+	return center;
+}
+
+float AArenaGrid::GetTileSurfaceHeight(int tile) const
+{
+	// Prefer the stored height, it is where the tile is going to be even while it is still moving
+	if (FloorHeights.IsValidIndex(tile))
+		return FloorHeights[tile] + TileSurfaceHeight;
+
+	if (FloorPieces.IsValidIndex(tile) && FloorPieces[tile])
+		return FloorPieces[tile]->GetActorLocation().Z + TileSurfaceHeight;
+
+	return MinHeight + TileSurfaceHeight;
+}
+
+int AArenaGrid::GetTileDistance(int a, int b) const
+{
+	if (!mTileCoords.IsValidIndex(a) || !mTileCoords.IsValidIndex(b))
+		return INDEX_NONE;
+
+	FIntPoint diff = mTileCoords[a] - mTileCoords[b];
+	return (FMath::Abs(diff.X) + FMath::Abs(diff.Y) + FMath::Abs(diff.X + diff.Y)) / 2;
+}
+
+int AArenaGrid::GetRingsForDistance(float distance) const
+{
+	if (mLayoutSize <= 0.0f)
+		return 0;
+
+	// Neighbouring tile centers are sqrt(3) * size apart, and the point can be anywhere on its tile
+	return FMath::CeilToInt((distance + mLayoutSize) / (FMath::Sqrt(3.0f) * mLayoutSize));
+}
+
+void AArenaGrid::GetTilesInRange(int tile, int rings, TArray<int>& outTiles) const
+{
+	outTiles.Reset();
+	ForEachTileInRange(tile, rings, [&outTiles](int found) { outTiles.Add(found); });
+}
+
+bool AArenaGrid::HasLineOfSight(FVector from, FVector to) const
+{
+	return HasTileLineOfSight(GetTileAtLocation(from), from.Z, GetTileAtLocation(to), to.Z);
+}
+
+void AArenaGrid::BatchLineOfSight(FVector from, const TArray<FVector>& targets, TArray<bool>& outVisible) const
+{
+	outVisible.SetNumUninitialized(targets.Num());
+
+	// The start tile only has to be found once for every target
+	int fromTile = GetTileAtLocation(from);
+	for (int i = 0; i < targets.Num(); i++)
+	{
+		outVisible[i] = HasTileLineOfSight(fromTile, from.Z, GetTileAtLocation(targets[i]), targets[i].Z);
+	}
+}
+
+bool AArenaGrid::HasTileLineOfSight(int fromTile, float fromHeight, int toTile, float toHeight) const
+{
+	// Lines that leave the grid or a floor without heights can't be blocked by it
+	if (!mTileCoords.IsValidIndex(fromTile) || !mTileCoords.IsValidIndex(toTile) || FloorHeights.Num() < mTileCoords.Num())
+		return true;
+
+	int distance = GetTileDistance(fromTile, toTile);
+	if (distance <= 1)
+		return true;
+
+	// Nudge the start point so the line never lands exactly on an edge between two tiles
+	FIntPoint a = mTileCoords[fromTile];
+	FIntPoint b = mTileCoords[toTile];
+	float aQ = a.X + 1e-6f;
+	float aR = a.Y + 1e-6f;
+	float aS = -a.X - a.Y - 2e-6f;
+	float step = 1.0f / distance;
+
+	// Walk the tiles in between the two end points. See https://www.redblobgames.com/grids/hexagons/ (Line drawing section)
+	for (int i = 1; i < distance; i++)
+	{
+		float t = step * i;
+		HexCell cell = HexRound(FMath::Lerp(aQ, (float)b.X, t), FMath::Lerp(aR, (float)b.Y, t), FMath::Lerp(aS, (float)(-b.X - b.Y), t));
+
+		// The line is blocked if the top of this tile is above the line at this point
+		int tile = GetTileAtAxial(cell.GetQ(), cell.GetR());
+		if (tile != INDEX_NONE && FloorHeights[tile] + TileSurfaceHeight > FMath::Lerp(fromHeight, toHeight, t))
+			return false;
+	}
+
+	return true;
+}
+
+void AArenaGrid::RegisterUnit(ABaseUnit* unit)
+{
+	if (!unit || Occupancy.GetUnit(unit->mOccupancyHandle) == unit)
+		return;
+
+	// Place the unit on the tile it starts on and stamp in its influence
+	EInfluenceLayer layer;
+	float strength = GetUnitInfluence(unit, layer);
+	unit->mCurrentTile = GetTileAtLocation(unit->GetActorLocation());
+	unit->mOccupancyHandle = Occupancy.AddUnit(unit, unit->mCurrentTile);
+	InfluenceMap.AddSource(layer, unit->mCurrentTile, strength);
+}
+
+void AArenaGrid::UnregisterUnit(ABaseUnit* unit)
+{
+	if (!unit || Occupancy.GetUnit(unit->mOccupancyHandle) != unit)
+		return;
+
+	// Take the unit's influence back out
+	EInfluenceLayer layer;
+	float strength = GetUnitInfluence(unit, layer);
+	InfluenceMap.AddSource(layer, unit->mCurrentTile, -strength);
+
+	Occupancy.RemoveUnit(unit->mOccupancyHandle);
+	unit->mOccupancyHandle = INDEX_NONE;
+	unit->mCurrentTile = INDEX_NONE;
+}
+
+void AArenaGrid::GetUnitsInRange(int tile, int rings, TArray<ABaseUnit*>& outUnits) const
+{
+	outUnits.Reset();
+
+	ForEachTileInRange(tile, rings, [this, &outUnits](int found)
+	{
+		for (int handle : Occupancy.GetTileUnits(found))
+		{
+			outUnits.Add(Occupancy.GetUnit(handle));
+		}
+	});
+}
+
+void AArenaGrid::GetUnitsNearLocation(FVector location, int rings, TArray<ABaseUnit*>& outUnits) const
+{
+	GetUnitsInRange(GetTileAtLocation(location), rings, outUnits);
+}
+
+float AArenaGrid::SampleInfluence(EInfluenceLayer layer, FVector location) const
+{
+	return InfluenceMap.Sample(layer, GetTileAtLocation(location));
+}
+
+void AArenaGrid::AddTileEffect(FVector location, float healPerSecond, float damagePerSecond, float duration)
+{
+	int tile = GetTileAtLocation(location);
+	if (tile == INDEX_NONE)
+		return;
+
+	TileEffects.AddEffect(FTileEffect(tile, healPerSecond, damagePerSecond, duration));
+
+	// Damaging tiles are hazards for the AI until the effect wears off
+	if (damagePerSecond > 0.0f)
+		InfluenceMap.AddSource(HAZARD, tile, ToxicHazardStrength);
+}
+
+void AArenaGrid::UpdateTileEffects(float deltaTime)
+{
+	// Remove the hazards of spills that dried up
+	TArray<FTileEffect> expired;
+	TileEffects.Tick(deltaTime, expired);
+	for (const FTileEffect& effect : expired)
+	{
+		if (effect.DamagePerSecond > 0.0f)
+			InfluenceMap.AddSource(HAZARD, effect.Tile, -ToxicHazardStrength);
+	}
+
+	// Effects are applied in steps rather than every frame
+	mTileEffectTimer -= deltaTime;
+	if (mTileEffectTimer > 0.0f)
+		return;
+	mTileEffectTimer += TileEffectInterval;
+
+	// Gather the change in health of every affected unit first, healing or damaging can remove units from the grid
+	TArray<TPair<ABaseUnit*, float>> changes;
+	for (int tile : TileEffects.GetActiveTiles())
+	{
+		float amount = TileEffects.GetNetRate(tile) * TileEffectInterval;
+		if (amount == 0.0f)
+			continue;
+
+		for (int handle : Occupancy.GetTileUnits(tile))
+		{
+			ABaseUnit* unit = Occupancy.GetUnit(handle);
+			if (unit->mIsPlayerUnit || TileEffectsAffectEnemies)
+				changes.Add(TPair<ABaseUnit*, float>(unit, amount));
+		}
+	}
+
+	// Apply all the changes in one batch, damage goes through the damage queue like any other hit
+	UDamageQueueSubsystem* damageQueue = UDamageQueueSubsystem::Get(this);
+	for (const TPair<ABaseUnit*, float>& change : changes)
+	{
+		if (!IsValid(change.Key))
+			continue;
+
+		if (change.Value > 0.0f)
+			change.Key->Heal(change.Value);
+		else if (damageQueue)
+			damageQueue->QueueDamage(change.Key, -change.Value);
+		else
+			change.Key->TakeDamage_Unit(-change.Value);
+	}
+}
+
+AActor* AArenaGrid::SpawnEnemy(TSubclassOf<AActor> enemyClass, FVector location, FRotator rotation, const FActorSpawnParameters& spawnParams)
+{
+	// Units come from the pool so dead ones from earlier levels are reused
+	UUnitPoolSubsystem* pool = UUnitPoolSubsystem::Get(this);
+	if (pool && enemyClass->IsChildOf(ABaseUnit::StaticClass()))
+		return pool->AcquireUnit(TSubclassOf<ABaseUnit>(enemyClass), location, rotation, spawnParams.Owner, spawnParams.SpawnCollisionHandlingOverride);
+
+	return GetWorld()->SpawnActor<AActor>(enemyClass, location, rotation, spawnParams);
+}
+
+float AArenaGrid::GetTopperRate(TSubclassOf<AActor> topperClass, FName property) const
+{
+	if (!UseNativeTileEffects || !topperClass || TopperEffectPeriod <= 0.0f)
+		return 0.0f;
+
+	// The amount is a blueprint variable, so it is read off the class defaults by name
+	FFloatProperty* amount = FindFProperty<FFloatProperty>(*topperClass, property);
+	if (!amount)
+		return 0.0f;
+
+	return amount->GetPropertyValue_InContainer(topperClass->GetDefaultObject()) / TopperEffectPeriod;
+}
+
+void AArenaGrid::DisableEffectVolume(AActor* actor)
+{
+	if (!actor)
+		return;
+
+	// The toppers' trigger spheres and boxes are shape components, their meshes keep their overlaps
+	TInlineComponentArray<UShapeComponent*> components;
+	actor->GetComponents(components);
+	for (UShapeComponent* component : components)
+	{
+		component->SetGenerateOverlapEvents(false);
+	}
+}
+
+void AArenaGrid::UpdateUnitTiles()
+{
+	for (int handle = 0; handle < Occupancy.GetMaxHandle(); handle++)
+	{
+		ABaseUnit* unit = Occupancy.GetUnit(handle);
+		if (!unit)
+			continue;
+
+		// Only units that crossed a tile boundary touch the occupancy index and influence map
+		int tile = GetTileAtLocation(unit->GetActorLocation());
+		if (tile != unit->mCurrentTile)
+		{
+			EInfluenceLayer layer;
+			float strength = GetUnitInfluence(unit, layer);
+			InfluenceMap.MoveSource(layer, unit->mCurrentTile, tile, strength);
+			Occupancy.MoveUnit(handle, tile);
+
+			unit->mCurrentTile = tile;
+		}
+	}
+}
+
+float AArenaGrid::GetUnitInfluence(const ABaseUnit* unit, EInfluenceLayer& outLayer) const
+{
+	// Players threaten, everything else is an ally of the gladiator
+	if (unit->mIsPlayerUnit)
+	{
+		outLayer = THREAT;
+		return PlayerThreatStrength;
+	}
+
+	outLayer = ALLIES;
+	return AllyStrength;
+}
+
 // Called every frame
 void AArenaGrid::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	// Keep the influence map in sync with the units on the grid
+	UpdateUnitTiles();
+	InfluenceMap.Decay(DeltaTime, InfluenceHalfLife);
+
+	// Only the server changes health and moves units along the flow field
+	if (HasAuthority())
+	{
+		UpdateTileEffects(DeltaTime);
+
+		mFlowFieldTimer -= DeltaTime;
+		if (mFlowFieldTimer <= 0.0f)
+		{
+			mFlowFieldTimer += FlowFieldInterval;
+			UpdateFlowField();
+		}
+
+		// Does nothing once the table is built until the floor moves again
+		Visibility.Update(this, VisibilityEyeHeight, VisibilityPairsPerFrame);
+		UpdatePerceptionPlayers();
+
+		// The floor, toppers and nav links sleep on the network while the layout is still
+		UpdateNetDormancy(DeltaTime);
+	}
+}
+
+void AArenaGrid::UpdateFlowField()
+{
+	TArray<int> goals;
+	if (UPlayerRegistrySubsystem* registry = UPlayerRegistrySubsystem::Get(this))
+	{
+		for (AActor* player : registry->GetPlayers())
+		{
+			if (IsValid(player))
+				goals.Add(GetTileAtLocation(player->GetActorLocation()));
+		}
+	}
+
+	FlowField.Build(this, goals, JumpDifferenceThreshhold);
+}
+
+void AArenaGrid::UpdatePerceptionPlayers()
+{
+	mPerceptionPlayers.Reset();
+	mPerceptionPlayerTiles.Reset();
+
+	// Masks worked out earlier this frame have bits for the old list of players
+	for (uint64& frame : mTileVisibleFrames)
+	{
+		frame = MAX_uint64;
+	}
+
+	if (UPlayerRegistrySubsystem* registry = UPlayerRegistrySubsystem::Get(this))
+	{
+		for (AActor* player : registry->GetPlayers())
+		{
+			// Masks only have room for 32 players
+			if (mPerceptionPlayers.Num() >= 32)
+				break;
+
+			if (IsValid(player))
+			{
+				mPerceptionPlayers.Add(player);
+				mPerceptionPlayerTiles.Add(GetTileAtLocation(player->GetActorLocation()));
+			}
+		}
+	}
+}
+
+uint32 AArenaGrid::GetVisiblePlayerMask(int tile)
+{
+	if (!FloorPieces.IsValidIndex(tile))
+		return 0;
+
+	if (mTileVisibleMasks.Num() != FloorPieces.Num())
+	{
+		mTileVisibleMasks.Init(0, FloorPieces.Num());
+		mTileVisibleFrames.Init(MAX_uint64, FloorPieces.Num());
+	}
+
+	// Every unit on a tile sees the same players, so each tile is only worked out once per frame
+	if (mTileVisibleFrames[tile] != GFrameCounter)
+	{
+		uint32 mask = 0;
+		for (int i = 0; i < mPerceptionPlayerTiles.Num(); i++)
+		{
+			if (CanTileSeeTile(tile, mPerceptionPlayerTiles[i]))
+				mask |= 1u << i;
+		}
+
+		mTileVisibleMasks[tile] = mask;
+		mTileVisibleFrames[tile] = GFrameCounter;
+	}
+
+	return mTileVisibleMasks[tile];
+}
+
+void AArenaGrid::GetVisiblePlayers(int tile, TArray<AActor*>& outPlayers)
+{
+	outPlayers.Reset();
+
+	uint32 mask = GetVisiblePlayerMask(tile);
+	for (int i = 0; mask != 0 && i < mPerceptionPlayers.Num(); i++, mask >>= 1)
+	{
+		if ((mask & 1) && IsValid(mPerceptionPlayers[i]))
+			outPlayers.Add(mPerceptionPlayers[i]);
+	}
 }
 
 // class UNavigationSystemV1;
@@ -747,9 +1396,8 @@ void AArenaGrid::CreateNavLinks()
 			}
 		}
 	}
-	
-
-
 
+	// The new nav links replicate until the layout settles again
+	WakeArena();
 }
 
@@ -0,0 +1,374 @@
+/**
+ * @file ArenaReplicationGraph.cpp
+ * @brief Defines the replication graph for the arena, which only considers the actors near each player
+ * @dependencies ReplicationGraph.h, ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "ArenaReplicationGraph.h"
+#include "ArenaGrid.h"
+#include "BaseUnit.h"
+#include "Weapon.h"
+#include "Armor.h"
+#include "Upgrade.h"
+#include "GameFramework/Info.h"
+#include "Engine/NetDriver.h"
+
+void UReplicationGraphNode_HexTile::GatherActorListsAtRate(const FConnectionGatherActorListParameters& params, int periodScale)
+{
+	GatherActorListsForConnection(params);
+
+	for (int i = 0; i < ReplicationActorList.Num(); i++)
+	{
+		AActor* actor = ReplicationActorList[i];
+		const FGlobalActorReplicationInfo& globalInfo = GraphGlobals->GlobalActorReplicationInfoMap->Get(actor);
+		FConnectionReplicationActorInfo& info = params.ConnectionManager.ActorInfoMap.FindOrAdd(actor);
+
+		uint16 period = (uint16)FMath::Min(globalInfo.Settings.ReplicationPeriodFrame * periodScale, (int)MAX_uint16);
+		if (period == info.ReplicationPeriodFrame)
+			continue;
+
+		// An actor coming closer shouldn't sit out the rest of the longer wait it was given while far away
+		info.ReplicationPeriodFrame = period;
+		info.NextReplicationFrameNum = FMath::Min(info.NextReplicationFrameNum, params.ReplicationFrameNum + period);
+	}
+}
+
+UReplicationGraphNode_HexGrid::UReplicationGraphNode_HexGrid()
+{
+	bRequiresPrepareForReplicationCall = true;
+
+	CullDistance = 5000.0f;
+	FullRateDistance = 3000.0f;
+	MaxPeriodScale = 4;
+
+	mNumTiles = 0;
+	mCullRings = 0;
+	mFullRateRings = 0;
+	mLayoutOrigin = FVector::ZeroVector;
+	mLayoutSize = 0.0f;
+	mpOffGridNode = nullptr;
+}
+
+void UReplicationGraphNode_HexGrid::NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo)
+{
+	AddActor_Dynamic(ActorInfo);
+}
+
+bool UReplicationGraphNode_HexGrid::NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound)
+{
+	int index = mActors.Find(ActorInfo.Actor);
+	if (index == INDEX_NONE)
+		return false;
+
+	if (UReplicationGraphNode_ActorList* node = GetTileNode(mActorTiles[index]))
+		node->NotifyRemoveNetworkActor(ActorInfo, bWarnIfNotFound);
+
+	mActors.RemoveAtSwap(index, 1, false);
+	mActorTiles.RemoveAtSwap(index, 1, false);
+	mActorIsDynamic.RemoveAtSwap(index, 1, false);
+	return true;
+}
+
+void UReplicationGraphNode_HexGrid::NotifyResetAllNetworkActors()
+{
+	for (UReplicationGraphNode_HexTile* node : mTileNodes)
+	{
+		node->NotifyResetAllNetworkActors();
+	}
+
+	if (mpOffGridNode)
+		mpOffGridNode->NotifyResetAllNetworkActors();
+
+	mActors.Reset();
+	mActorTiles.Reset();
+	mActorIsDynamic.Reset();
+}
+
+void UReplicationGraphNode_HexGrid::AddActor(const FNewReplicatedActorInfo& actorInfo, bool isDynamic)
+{
+	if (!mpOffGridNode)
+		mpOffGridNode = CreateChildNode<UReplicationGraphNode_ActorList>();
+
+	AArenaGrid* arena = mpArena.Get();
+	int index = mActors.Add(actorInfo.Actor);
+	mActorTiles.Add(INDEX_NONE);
+	mActorIsDynamic.Add(isDynamic);
+
+	PlaceActor(index, arena ? arena->GetTileAtLocation(actorInfo.Actor->GetActorLocation()) : INDEX_NONE);
+}
+
+void UReplicationGraphNode_HexGrid::PlaceActor(int index, int tile)
+{
+	// Every actor starts in the off grid node until the arena is found, so it is never missing from both
+	if (tile >= mNumTiles)
+		tile = INDEX_NONE;
+
+	if (UReplicationGraphNode_ActorList* node = GetTileNode(tile))
+		node->NotifyAddNetworkActor(FNewReplicatedActorInfo(mActors[index]));
+
+	mActorTiles[index] = tile;
+}
+
+void UReplicationGraphNode_HexGrid::UpdateArena()
+{
+	AArenaGrid* arena = mpArena.Get();
+	if (!arena && GraphGlobals.IsValid())
+		arena = AArenaGrid::FindArena(GraphGlobals->World);
+
+	int numTiles = arena ? arena->FloorPieces.Num() : 0;
+	FVector layoutOrigin = arena ? arena->GetLayoutOrigin() : FVector::ZeroVector;
+	float layoutSize = arena ? arena->GetLayoutSize() : 0.0f;
+	if (arena == mpArena.Get() && numTiles == mNumTiles && layoutOrigin == mLayoutOrigin && layoutSize == mLayoutSize)
+		return;
+
+	// The arena was built, rebuilt, moved, resized or removed, so every actor is bucketed again
+	mpArena = arena;
+	mNumTiles = numTiles;
+	mLayoutOrigin = layoutOrigin;
+	mLayoutSize = layoutSize;
+	mCullRings = arena ? arena->GetRingsForDistance(CullDistance) : 0;
+	mFullRateRings = arena && FullRateDistance > 0.0f ? arena->GetRingsForDistance(FullRateDistance) : 0;
+
+	while (mTileNodes.Num() < mNumTiles)
+	{
+		mTileNodes.Add(CreateChildNode<UReplicationGraphNode_HexTile>());
+	}
+
+	for (UReplicationGraphNode_HexTile* node : mTileNodes)
+	{
+		node->NotifyResetAllNetworkActors();
+	}
+
+	if (mpOffGridNode)
+		mpOffGridNode->NotifyResetAllNetworkActors();
+
+	for (int i = 0; i < mActors.Num(); i++)
+	{
+		PlaceActor(i, arena ? arena->GetTileAtLocation(mActors[i]->GetActorLocation()) : INDEX_NONE);
+	}
+}
+
+int UReplicationGraphNode_HexGrid::GetPeriodScale(int rings) const
+{
+	if (mFullRateRings <= 0 || rings <= mFullRateRings)
+		return 1;
+
+	// The wait grows with distance, like a priority that falls off past the full rate distance
+	return FMath::Clamp(FMath::DivideAndRoundUp(rings, mFullRateRings), 1, FMath::Max(MaxPeriodScale, 1));
+}
+
+void UReplicationGraphNode_HexGrid::PrepareForReplication()
+{
+	UpdateArena();
+
+	AArenaGrid* arena = mpArena.Get();
+	if (!arena)
+		return;
+
+	// Only actors that changed tile since last frame are moved between nodes
+	for (int i = 0; i < mActors.Num(); i++)
+	{
+		if (!mActorIsDynamic[i])
+			continue;
+
+		int tile = arena->GetTileAtLocation(mActors[i]->GetActorLocation());
+		if (tile >= mNumTiles)
+			tile = INDEX_NONE;
+
+		if (tile == mActorTiles[i])
+			continue;
+
+		if (UReplicationGraphNode_ActorList* node = GetTileNode(mActorTiles[i]))
+			node->NotifyRemoveNetworkActor(FNewReplicatedActorInfo(mActors[i]), false);
+
+		PlaceActor(i, tile);
+	}
+}
+
+void UReplicationGraphNode_HexGrid::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	if (mpOffGridNode)
+		mpOffGridNode->GatherActorListsForConnection(Params);
+
+	AArenaGrid* arena = mpArena.Get();
+	if (!arena)
+		return;
+
+	// Split screen connections have a viewer per player, a tile near two of them is only gathered once at the
+	// rate of the nearest one
+	mGatherTiles.Reset();
+	mGatherRings.Reset();
+	bool gatherAll = false;
+	for (const FNetViewer& viewer : Params.Viewers)
+	{
+		int tile = arena->GetTileAtLocation(viewer.ViewLocation);
+		if (tile == INDEX_NONE)
+		{
+			gatherAll = true;
+			break;
+		}
+
+		arena->ForEachTileInRange(tile, mCullRings, [&](int found)
+		{
+			int rings = arena->GetTileDistance(tile, found);
+			int index = mGatherTiles.Find(found);
+			if (index == INDEX_NONE)
+			{
+				mGatherTiles.Add(found);
+				mGatherRings.Add(rings);
+			}
+			else
+				mGatherRings[index] = FMath::Min(mGatherRings[index], rings);
+		});
+	}
+
+	// A viewer off the edge of the grid isn't near any tile in particular, so it is given all of them
+	if (gatherAll)
+	{
+		for (int tile = 0; tile < mNumTiles; tile++)
+		{
+			mTileNodes[tile]->GatherActorListsAtRate(Params, 1);
+		}
+		return;
+	}
+
+	for (int i = 0; i < mGatherTiles.Num(); i++)
+	{
+		if (mGatherTiles[i] < mNumTiles)
+			mTileNodes[mGatherTiles[i]]->GatherActorListsAtRate(Params, GetPeriodScale(mGatherRings[i]));
+	}
+}
+
+UArenaReplicationGraph::UArenaReplicationGraph()
+{
+	// Overridden by DefaultGame.ini
+	SpatialCullDistance = 5000.0f;
+	LootCullDistance = 3000.0f;
+	LootUpdateFrequency = 2.0f;
+	FullRateDistance = 3000.0f;
+	MaxPeriodScale = 4;
+
+	mpHexGridNode = nullptr;
+	mpAlwaysRelevantNode = nullptr;
+	mpArenaNode = nullptr;
+}
+
+void UArenaReplicationGraph::SetClassInfo(UClass* actorClass, float netUpdateFrequency, float cullDistance)
+{
+	float tickRate = NetDriver ? NetDriver->NetServerMaxTickRate : 30.0f;
+
+	FClassReplicationInfo classInfo;
+	classInfo.ReplicationPeriodFrame = (uint16)FMath::Max(FMath::RoundToInt(tickRate / FMath::Max(netUpdateFrequency, 0.01f)), 1);
+	classInfo.SetCullDistanceSquared(FMath::Square(cullDistance));
+	GlobalActorReplicationInfoMap.SetClassInfo(actorClass, classInfo);
+}
+
+void UArenaReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	// Units use whatever their class defaults ask for
+	const ABaseUnit* unitDefaults = GetDefault<ABaseUnit>();
+	SetClassInfo(ABaseUnit::StaticClass(), unitDefaults->NetUpdateFrequency, FMath::Sqrt(unitDefaults->NetCullDistanceSquared));
+
+	// Loot sits on the floor until it is picked up, far away players don't need it and it rarely changes
+	SetClassInfo(AWeapon::StaticClass(), LootUpdateFrequency, LootCullDistance);
+	SetClassInfo(AArmor::StaticClass(), LootUpdateFrequency, LootCullDistance);
+	SetClassInfo(AUpgrade::StaticClass(), LootUpdateFrequency, LootCullDistance);
+}
+
+void UArenaReplicationGraph::InitGlobalGraphNodes()
+{
+	Super::InitGlobalGraphNodes();
+
+	mpHexGridNode = CreateNewNode<UReplicationGraphNode_HexGrid>();
+	mpHexGridNode->CullDistance = SpatialCullDistance;
+	mpHexGridNode->FullRateDistance = FullRateDistance;
+	mpHexGridNode->MaxPeriodScale = MaxPeriodScale;
+	AddGlobalGraphNode(mpHexGridNode);
+
+	mpAlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(mpAlwaysRelevantNode);
+
+	mpArenaNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(mpArenaNode);
+}
+
+void UArenaReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	// The connection's own controller, pawn and view target
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* ownerNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(ownerNode, RepGraphConnection);
+}
+
+EArenaRepPolicy UArenaReplicationGraph::GetPolicy(const AActor* actor) const
+{
+	if (actor->bOnlyRelevantToOwner)
+		return EArenaRepPolicy::NotRouted;
+
+	if (actor->bAlwaysRelevant || actor->IsA<AInfo>() || actor->IsA<AArenaGrid>())
+		return EArenaRepPolicy::RelevantAllConnections;
+
+	// Loot can be picked up, attached or moved by blueprints, so it is rebucketed like units
+	if (actor->IsA<ABaseUnit>() || actor->IsA<AWeapon>() || actor->IsA<AArmor>() || actor->IsA<AUpgrade>())
+		return EArenaRepPolicy::Spatialize_Dynamic;
+
+	// Everything else the arena spawns is part of the layout: floor pieces, toppers and nav links
+	if (Cast<AArenaGrid>(actor->GetOwner()))
+		return EArenaRepPolicy::ArenaStatic;
+
+	const USceneComponent* root = actor->GetRootComponent();
+	return root && root->Mobility == EComponentMobility::Static ? EArenaRepPolicy::Spatialize_Static : EArenaRepPolicy::Spatialize_Dynamic;
+}
+
+void UArenaReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	switch (GetPolicy(ActorInfo.Actor))
+	{
+	case EArenaRepPolicy::RelevantAllConnections:
+		mpAlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+
+	case EArenaRepPolicy::ArenaStatic:
+		mpArenaNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+
+	case EArenaRepPolicy::Spatialize_Static:
+		mpHexGridNode->AddActor_Static(ActorInfo);
+		break;
+
+	case EArenaRepPolicy::Spatialize_Dynamic:
+		mpHexGridNode->AddActor_Dynamic(ActorInfo);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void UArenaReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	switch (GetPolicy(ActorInfo.Actor))
+	{
+	case EArenaRepPolicy::RelevantAllConnections:
+		mpAlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+
+	case EArenaRepPolicy::ArenaStatic:
+		mpArenaNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+
+	case EArenaRepPolicy::Spatialize_Static:
+	case EArenaRepPolicy::Spatialize_Dynamic:
+		mpHexGridNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+
+	default:
+		break;
+	}
+}
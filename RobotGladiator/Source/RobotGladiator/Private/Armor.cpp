@@ -8,6 +8,7 @@
  **/
 
 #include "Armor.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 AArmor::AArmor()
 {
@@ -23,6 +24,10 @@ void AArmor::SetArmorStats(int defense, ERarities rarity, EArmorTypes type)
 	DefenseStat = defense;
 	Rarity = rarity;
 	ArmorType = type;
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(AArmor, DefenseStat, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AArmor, Rarity, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AArmor, ArmorType, this);
 }
 
 void AArmor::BeginPlay()
@@ -33,10 +38,16 @@ void AArmor::BeginPlay()
 
 void AArmor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
-	DOREPLIFETIME(AArmor, DefenseStat);
-	DOREPLIFETIME(AArmor, ArmorName);
-	DOREPLIFETIME(AArmor, Rarity);
-	DOREPLIFETIME(AArmor, ArmorType);
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Push model, on engines built with it stats are only compared after SetArmorStats or a blueprint changes them
+	FDoRepLifetimeParams params;
+	params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AArmor, DefenseStat, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AArmor, ArmorName, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AArmor, Rarity, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AArmor, ArmorType, params);
 }
 
 void AArmor::Tick(float DeltaTime)
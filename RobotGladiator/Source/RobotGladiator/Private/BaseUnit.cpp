@@ -10,28 +10,145 @@
  **/
 
 #include "BaseUnit.h"
+#include "ArenaGrid.h"
+#include "PlayerRegistrySubsystem.h"
+#include "UnitAIManager.h"
+#include "DamageQueueSubsystem.h"
+#include "StatusEffectSubsystem.h"
+#include "UnitPoolSubsystem.h"
+#include "MeleeResolverSubsystem.h"
+#include "LagCompensationSubsystem.h"
+#include "CrowdAvoidanceSubsystem.h"
+#include "GruntMovementComponent.h"
+#include "CombatRules.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "UnitMovementComponent.h"
+#include "AIController.h"
+#include "BrainComponent.h"
 
 // Sets default values
-ABaseUnit::ABaseUnit()
+ABaseUnit::ABaseUnit(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USkeletalMeshComponentBudgeted>(ACharacter::MeshComponentName)
+		.SetDefaultSubobjectClass<UUnitMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
  	// Set this pawn to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	mIsPlayerUnit = false;
+	mCurrentTile = INDEX_NONE;
+	mOccupancyHandle = INDEX_NONE;
+	mpArena = nullptr;
+	mUseNativeAI = false;
+	mAIHandle = INDEX_NONE;
+	mAvoidanceHandle = INDEX_NONE;
+	mStatusHandle = INDEX_NONE;
+	mHistoryHandle = INDEX_NONE;
+	mAILODTier = AI_LOD_NEAR;
+	mIsActive = true;
+	mSpeedScale = 1.0f;
+	mSentMaxHealth = 0.0f;
+
+	// The significance subsystem rates every unit for the animation budget allocator
+	if (USkeletalMeshComponentBudgeted* mesh = Cast<USkeletalMeshComponentBudgeted>(GetMesh()))
+		mesh->SetAutoCalculateSignificance(false);
 }
 
 // Called when the game starts or when spawned
 void ABaseUnit::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	// Units that never set a max health start out at full health
+	if (mMaxHealth <= 0.0f)
+		mMaxHealth = mHealth;
+
+	RegisterWithSystems();
+}
+
+// Called when the unit is removed from the world
+void ABaseUnit::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterFromSystems();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ABaseUnit::RegisterWithSystems()
+{
+	// Let the arena track which tile this unit is on
+	mpArena = AArenaGrid::FindArena(this);
+	if (mpArena)
+		mpArena->RegisterUnit(this);
+
+	// Let enemies find players without searching every actor in the world
+	if (mIsPlayerUnit)
+	{
+		if (UPlayerRegistrySubsystem* registry = UPlayerRegistrySubsystem::Get(this))
+			registry->RegisterPlayer(this);
+	}
+
+	// Hand decision making over to the AI manager on the server, the actor keeps ticking for its blueprint
+	if (mUseNativeAI && !mIsPlayerUnit && HasAuthority())
+	{
+		if (UUnitAIManager* manager = UUnitAIManager::Get(this))
+			manager->RegisterUnit(this);
+	}
+
+	// Keep a history of where the unit was so the server can check players' hits against what they saw
+	if (HasAuthority())
+	{
+		if (ULagCompensationSubsystem* lagCompensation = ULagCompensationSubsystem::Get(this))
+			lagCompensation->RegisterUnit(this);
+	}
+
+	// Grunts steer around each other, steering is only worked out on the server and replicated through movement
+	if (HasAuthority() && Cast<UGruntMovementComponent>(GetCharacterMovement()))
+	{
+		if (UCrowdAvoidanceSubsystem* crowd = UCrowdAvoidanceSubsystem::Get(this))
+			crowd->RegisterAgent(this);
+	}
+}
+
+void ABaseUnit::UnregisterFromSystems()
+{
+	if (mpArena)
+		mpArena->UnregisterUnit(this);
+
+	if (mIsPlayerUnit)
+	{
+		if (UPlayerRegistrySubsystem* registry = UPlayerRegistrySubsystem::Get(this))
+			registry->UnregisterPlayer(this);
+	}
+
+	if (UUnitAIManager* manager = UUnitAIManager::Get(this))
+		manager->UnregisterUnit(this);
+
+	// Dead units lose their effects
+	if (UStatusEffectSubsystem* statusEffects = UStatusEffectSubsystem::Get(this))
+		statusEffects->RemoveUnit(this);
+
+	if (ULagCompensationSubsystem* lagCompensation = ULagCompensationSubsystem::Get(this))
+		lagCompensation->UnregisterUnit(this);
+
+	if (UCrowdAvoidanceSubsystem* crowd = UCrowdAvoidanceSubsystem::Get(this))
+		crowd->UnregisterAgent(this);
 }
 
 void ABaseUnit::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(ABaseUnit, mHealth);
-	DOREPLIFETIME(ABaseUnit, mMaxHealth);
+	// Push model, these are only compared when they are marked dirty on engines built with it
+	FDoRepLifetimeParams params;
+	params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(ABaseUnit, mReplicatedHealth, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ABaseUnit, mMaxHealth, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ABaseUnit, mIsActive, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ABaseUnit, mSpeedScale, params);
 }
 
 // Called every frame
@@ -41,36 +158,26 @@ void ABaseUnit::Tick(float DeltaTime)
 
 }
 
-/**   @brief Get the closes player to the gladiator
+/**   @brief Get the closest actor in an array to this unit
  *	  @param {TArray<AActor*>} Array - array of actors to choose from -
- *    @return {AActor*} - the closest player to the gladiator
+ *    @return {AActor*} - the closest actor to this unit
  */
-AActor* ABaseUnit::GetClosestPlayer(TArray<AActor*> Array)
+AActor* ABaseUnit::GetClosestPlayer(const TArray<AActor*>& Array) const
 {
 	AActor* closestPlayer = nullptr;
-	float distance = INT_MAX;
+	float closestDistSq = MAX_flt;
+	FVector location = GetActorLocation();
 
-
-	//find the closes actor
+	//find the closest actor, comparing squared distances only
 	for (AActor* actor : Array)
 	{
-		if (actor != this)
+		if (actor && actor != this)
 		{
-			if (closestPlayer == nullptr)
+			float distSq = FVector::DistSquared(actor->GetActorLocation(), location);
+			if (distSq < closestDistSq)
 			{
 				closestPlayer = actor;
-				FVector dir = closestPlayer->GetActorLocation() - this->GetActorLocation();
-				distance = dir.Size();
-			}
-			else
-			{
-				FVector dir = actor->GetActorLocation() - this->GetActorLocation();
-
-				if (dir.SizeSquared() < distance * distance)
-				{
-					closestPlayer = actor;
-					distance = dir.Size();
-				}
+				closestDistSq = distSq;
 			}
 		}
 	}
@@ -78,6 +185,71 @@ AActor* ABaseUnit::GetClosestPlayer(TArray<AActor*> Array)
 	return closestPlayer;
 }
 
+/**   @brief Get the closest registered player to this unit without searching the world
+ *	  @param {TSubclassOf<AActor>} classFilter - only players of this class are considered, none for any player
+ *    @return {AActor*} - the closest player to this unit, nullptr if there are none
+ */
+AActor* ABaseUnit::FindClosestPlayer(TSubclassOf<AActor> classFilter) const
+{
+	UPlayerRegistrySubsystem* registry = UPlayerRegistrySubsystem::Get(this);
+	if (!registry)
+		return nullptr;
+
+	return registry->FindClosestPlayer(GetActorLocation(), classFilter, this);
+}
+
+/**   @brief Sample the arena's influence map at the tile this unit is standing on
+ *    @param {EInfluenceLayer} layer - the influence layer to sample
+ *    @return {float} - the influence on this unit's tile, 0 if there is no arena
+ */
+float ABaseUnit::SampleInfluence(EInfluenceLayer layer) const
+{
+	if (!mpArena)
+		return 0.0f;
+
+	return mpArena->InfluenceMap.Sample(layer, mCurrentTile);
+}
+
+/**   @brief Get the players this unit can see, from the arena's tile visibility table instead of sight traces
+ *    @return {TArray<AActor*>} - the visible players
+ */
+TArray<AActor*> ABaseUnit::GetVisiblePlayers() const
+{
+	TArray<AActor*> players;
+	if (mpArena)
+		mpArena->GetVisiblePlayers(mCurrentTile, players);
+
+	return players;
+}
+
+/**   @brief Check if this unit can see an actor, using the arena's tile visibility table
+ *    @param {AActor*} other - the actor to look for
+ *    @return {bool} - true if the floor doesn't block the view
+ */
+bool ABaseUnit::CanSeeActor(const AActor* other) const
+{
+	if (!other)
+		return false;
+
+	if (!mpArena)
+		return true;
+
+	return mpArena->CanTileSeeTile(mCurrentTile, mpArena->GetTileAtLocation(other->GetActorLocation()));
+}
+
+/**   @brief Called by the AI manager when the unit moves to a different LOD tier
+ *    @param {EAILODTier} tier - the unit's new tier
+ *    @param {float} movementTickInterval - how often the movement component should tick, 0 for every frame
+ */
+void ABaseUnit::SetAILOD(EAILODTier tier, float movementTickInterval)
+{
+	mAILODTier = tier;
+
+	// Far away units don't need smooth movement, nobody is close enough to see it
+	if (UCharacterMovementComponent* movement = GetCharacterMovement())
+		movement->SetComponentTickInterval(movementTickInterval);
+}
+
 // Called to bind functionality to input
 void ABaseUnit::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
@@ -91,15 +263,186 @@ void ABaseUnit::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
  */
 bool ABaseUnit::TakeDamage_Unit(float damage)
 {
-	mHealth -= damage;
-	if (mHealth <= 0)
+	// Clients are told their health by the server
+	if (!mIsActive || !HasAuthority())
+		return false;
+
+	if (CombatRules::ApplyDamage(mHealth, damage))
 	{
-		return Destroy();
+		Die();
+		return true;
 	}
 
 	return false;
 }
 
+/**   @brief Swings at everything in an arc in front of this unit, resolved by the melee resolver at the end of the frame
+ *    @param {float} angle - width of the arc in degrees
+ *    @param {float} range - how far the swing reaches
+ *    @param {float} damage - damage dealt to every unit hit
+ *    @return {void} null
+ */
+void ABaseUnit::MeleeSwing(float angle, float range, float damage)
+{
+	// Only the server decides who gets hit
+	if (!HasAuthority())
+		return;
+
+	if (UMeleeResolverSubsystem* resolver = UMeleeResolverSubsystem::Get(this))
+		resolver->QueueSwing(this, GetActorLocation(), GetActorForwardVector(), angle, range, damage);
+}
+
+/**   @brief Called once health reaches zero, at a point where nothing is iterating over units
+ *    @return {void} null
+ */
+void ABaseUnit::Die()
+{
+	// Clients see the unit die when the server pools or destroys it
+	if (!HasAuthority())
+		return;
+
+	OnDeath();
+
+	// Enemies are reused by later waves rather than rebuilt from scratch
+	UUnitPoolSubsystem* pool = UUnitPoolSubsystem::Get(this);
+	if (pool && !mIsPlayerUnit)
+		pool->ReleaseUnit(this);
+	else
+		Destroy();
+}
+
+/**   @brief Puts a pooled unit back into play with fresh health and state
+ *    @return {void} null
+ */
+void ABaseUnit::ActivateUnit()
+{
+	if (mIsActive)
+		return;
+
+	// Wake the unit up so clients hear about it again
+	SetNetDormancy(DORM_Awake);
+
+	mIsActive = true;
+	MARK_PROPERTY_DIRTY_FROM_NAME(ABaseUnit, mIsActive, this);
+	ResetUnit();
+	ApplyActiveState();
+	RegisterWithSystems();
+	ForceNetUpdate();
+
+	OnUnitReused();
+}
+
+/**   @brief Takes the unit out of play so it can wait in the unit pool
+ *    @return {void} null
+ */
+void ABaseUnit::DeactivateUnit()
+{
+	if (!mIsActive)
+		return;
+
+	UnregisterFromSystems();
+	mIsActive = false;
+	MARK_PROPERTY_DIRTY_FROM_NAME(ABaseUnit, mIsActive, this);
+	ApplyActiveState();
+
+	// Pooled units don't change, their channels send mIsActive and then go quiet until the unit is reused
+	SetNetDormancy(DORM_DormantAll);
+}
+
+/**   @brief Restores the unit's health and combat state to its class defaults
+ *    @return {void} null
+ */
+void ABaseUnit::ResetUnit()
+{
+	// The class defaults hold whatever the blueprint set up
+	const ABaseUnit* defaults = GetClass()->GetDefaultObject<ABaseUnit>();
+	mHealth = defaults->mHealth;
+	mMaxHealth = defaults->mMaxHealth > 0.0f ? defaults->mMaxHealth : mHealth;
+
+	mCurrentTile = INDEX_NONE;
+	mAILODTier = AI_LOD_NEAR;
+	SetSpeedScale(1.0f);
+}
+
+/**   @brief Sets the multiplier status effects put on the unit's walk speed
+ *    @param {float} scale - the multiplier, 1 for normal speed
+ *    @return {void} null
+ */
+void ABaseUnit::SetSpeedScale(float scale)
+{
+	if (mSpeedScale == scale)
+		return;
+
+	mSpeedScale = scale;
+	MARK_PROPERTY_DIRTY_FROM_NAME(ABaseUnit, mSpeedScale, this);
+}
+
+void ABaseUnit::ApplyActiveState()
+{
+	SetActorHiddenInGame(!mIsActive);
+	SetActorEnableCollision(mIsActive);
+
+	SetActorTickEnabled(mIsActive);
+
+	if (UCharacterMovementComponent* movement = GetCharacterMovement())
+	{
+		if (!mIsActive)
+			movement->StopMovementImmediately();
+
+		movement->SetComponentTickEnabled(mIsActive);
+	}
+
+	// Hidden meshes would otherwise keep updating their animation
+	if (USkeletalMeshComponent* mesh = GetMesh())
+		mesh->SetComponentTickEnabled(mIsActive);
+
+	// Pooled units stay possessed, their controller's tick and behaviour tree wait with them
+	if (AAIController* controller = Cast<AAIController>(GetController()))
+	{
+		controller->SetActorTickEnabled(mIsActive);
+
+		if (UBrainComponent* brain = controller->GetBrainComponent())
+		{
+			if (mIsActive)
+				brain->RestartLogic();
+			else
+				brain->StopLogic(TEXT("Unit pooled"));
+		}
+	}
+}
+
+void ABaseUnit::OnRep_IsActive()
+{
+	ApplyActiveState();
+}
+
+void ABaseUnit::OnRep_Health()
+{
+	if (!HasAuthority())
+		mHealth = mReplicatedHealth.Get(mMaxHealth);
+}
+
+void ABaseUnit::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	// Blueprints set mMaxHealth directly, so it is compared here rather than marked where it changes
+	if (mMaxHealth != mSentMaxHealth)
+	{
+		mSentMaxHealth = mMaxHealth;
+		MARK_PROPERTY_DIRTY_FROM_NAME(ABaseUnit, mMaxHealth, this);
+	}
+
+	// Health is changed in too many places, blueprints included, to mark every one. Packing it here costs one
+	// compare per net update and only dirties the property when clients would see a difference
+	FQuantizedHealth health;
+	health.Set(mHealth, mMaxHealth);
+	if (health != mReplicatedHealth)
+	{
+		mReplicatedHealth = health;
+		MARK_PROPERTY_DIRTY_FROM_NAME(ABaseUnit, mReplicatedHealth, this);
+	}
+}
 
 /**   @brief <heal>
  *    @param {<float>} hp - health
@@ -107,12 +450,7 @@ bool ABaseUnit::TakeDamage_Unit(float damage)
  */
 void ABaseUnit::Heal(float hp)
 {
-	mHealth += hp;
-
-	if (mHealth > mMaxHealth)
-	{
-		mHealth = mMaxHealth;
-	}
+	CombatRules::ApplyHeal(mHealth, mMaxHealth, hp);
 }
 
 /**   @brief <Heal an oposing unit>
@@ -126,17 +464,34 @@ void ABaseUnit::HealUnit(ABaseUnit* oposingUnit, float healAmount)
 		oposingUnit->Heal(healAmount);
 }
 
-/**   @brief <Deal damage to an oposing unit>
+/**   @brief Puts a status effect on an oposing unit, the effect is run by the status effect subsystem
+ *	  @param {ABaseUnit*} oposingUnit - unit to affect
+ *    @param {FStatusEffectSpec} effect - the effect and how it stacks
+ *    @return {bool} - true if the effect was applied
+ */
+bool ABaseUnit::ApplyStatusEffect(ABaseUnit* oposingUnit, const FStatusEffectSpec& effect)
+{
+	UStatusEffectSubsystem* statusEffects = UStatusEffectSubsystem::Get(this);
+	if (!statusEffects)
+		return false;
+
+	return statusEffects->ApplyEffect(oposingUnit, effect);
+}
+
+/**   @brief <Deal damage to an oposing unit, the damage is queued and applied at the end of the frame>
  *	  @param {ABaseUnit*} oposingUnit - <unit to take damage>
  *    @param {<float>} damage - damage>
- *    @return {<void>} - <null>
+ *    @return {<bool>} - <Returns true if this hit will kill the oposing unit>
  */
 bool ABaseUnit::DealDamage(ABaseUnit* oposingUnit, float damage)
 {
-	bool destroyed = false;
-	if(oposingUnit)
-		return oposingUnit->TakeDamage_Unit(damage);
+	if (!oposingUnit)
+		return false;
+
+	// Hits on the same unit this frame are added up and applied once
+	if (UDamageQueueSubsystem* damageQueue = UDamageQueueSubsystem::Get(this))
+		return damageQueue->QueueDamage(oposingUnit, damage, this);
 
-	return destroyed;
+	return oposingUnit->TakeDamage_Unit(damage);
 }
 
@@ -0,0 +1,337 @@
+/**
+ * @file CombatSim.cpp
+ * @brief Defines a headless, deterministic combat simulation for balance testing without a world or actors
+ * @dependencies CombatRules.h, StatusEffectSubsystem.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "CombatSim.h"
+#include "CombatRules.h"
+#include "Misc/Crc.h"
+
+FCombatSim::FCombatSim(int tickRate)
+{
+	mTickRate = FMath::Max(tickRate, 1);
+	Reset(0);
+}
+
+void FCombatSim::Reset(int seed)
+{
+	mTick = 0;
+	mNumAlive = 0;
+	mChecksum = 0;
+	mRand.Initialize(seed);
+
+	mTeams.Reset();
+	mHealth.Reset();
+	mMaxHealth.Reset();
+	mDamage.Reset();
+	mAttackTicks.Reset();
+	mCooldowns.Reset();
+	mRange.Reset();
+	mSpeed.Reset();
+	mCritChance.Reset();
+	mX.Reset();
+	mY.Reset();
+	mOnHitEffects.Reset();
+	mHealthDeltas.Reset();
+	mSpeedScales.Reset();
+	mPendingDamage.Reset();
+
+	mEffectUnits.Reset();
+	mEffectIds.Reset();
+	mEffectRates.Reset();
+	mEffectSpeeds.Reset();
+	mEffectStacks.Reset();
+	mEffectTicksLeft.Reset();
+	mEffectDefs.Reset();
+}
+
+int FCombatSim::AddUnit(const FSimUnitDef& def, FVector2D location)
+{
+	return AddUnitAt(def, ToFixed(location.X), ToFixed(location.Y));
+}
+
+void FCombatSim::AddGroup(const FSimUnitDef& def, int count, FVector2D center, float radius)
+{
+	int32 x = ToFixed(center.X);
+	int32 y = ToFixed(center.Y);
+	uint32 width = (uint32)ToFixed(FMath::Max(radius, 0.0f)) * 2 + 1;
+
+	for (int i = 0; i < count; i++)
+	{
+		int32 offsetX = (int32)(mRand.GetUnsignedInt() % width) - (int32)(width / 2);
+		int32 offsetY = (int32)(mRand.GetUnsignedInt() % width) - (int32)(width / 2);
+		AddUnitAt(def, x + offsetX, y + offsetY);
+	}
+}
+
+int FCombatSim::AddUnitAt(const FSimUnitDef& def, int32 x, int32 y)
+{
+	// Every float is converted here, nothing after this point touches floating point
+	int unit = mTeams.Add(def.Team);
+	mHealth.Add(ToFixed(def.MaxHealth));
+	mMaxHealth.Add(ToFixed(def.MaxHealth));
+	mDamage.Add(ToFixed(def.Damage));
+	mAttackTicks.Add(FMath::Max(FMath::RoundToInt(def.AttackInterval * mTickRate), 1));
+	mCooldowns.Add(0);
+	mRange.Add(ToFixed(def.Range));
+	mSpeed.Add(ToFixed(def.Speed / mTickRate));
+	mCritChance.Add((uint32)FMath::Clamp(ToFixed(def.CritChance), 0, FixedOne));
+	mX.Add(x);
+	mY.Add(y);
+	mHealthDeltas.Add(0);
+	mSpeedScales.Add(FixedOne);
+	mPendingDamage.Add(0);
+
+	int onHit = INDEX_NONE;
+	if (def.OnHitEffect.EffectId != NAME_None)
+	{
+		const FStatusEffectSpec& spec = def.OnHitEffect;
+
+		FSimEffect effect;
+		effect.Id = spec.EffectId;
+		effect.RatePerTick = ToFixed(spec.HealthPerSecond / mTickRate);
+		effect.SpeedMultiplier = ToFixed(spec.SpeedMultiplier);
+		effect.Ticks = spec.Duration > 0.0f ? FMath::Max(FMath::RoundToInt(spec.Duration * mTickRate), 1) : -1;
+		effect.Stacking = spec.Stacking;
+		effect.MaxStacks = FMath::Max(spec.MaxStacks, 1);
+		onHit = mEffectDefs.Add(effect);
+	}
+	mOnHitEffects.Add(onHit);
+
+	mNumAlive++;
+	return unit;
+}
+
+void FCombatSim::Step()
+{
+	StepEffects();
+
+	// Effects land first, a unit killed by one doesn't get to attack this tick
+	for (int i = 0; i < mTeams.Num(); i++)
+	{
+		int32 delta = mHealthDeltas[i];
+		if (delta == 0 || mHealth[i] <= 0)
+			continue;
+
+		if (delta > 0)
+			CombatRules::ApplyHeal(mHealth[i], mMaxHealth[i], delta);
+		else if (CombatRules::ApplyDamage(mHealth[i], -delta))
+			mNumAlive--;
+	}
+
+	for (int i = 0; i < mTeams.Num(); i++)
+	{
+		if (mHealth[i] <= 0)
+			continue;
+
+		if (mCooldowns[i] > 0)
+			mCooldowns[i]--;
+
+		int target = FindTarget(i);
+		if (target == INDEX_NONE)
+			continue;
+
+		int64 dx = (int64)mX[target] - mX[i];
+		int64 dy = (int64)mY[target] - mY[i];
+		int64 distSq = dx * dx + dy * dy;
+		int64 range = mRange[i];
+
+		// Walk towards the target until it is in range
+		if (distSq > range * range)
+		{
+			int64 dist = SquareRoot(distSq);
+			int64 move = FMath::Min((int64)mSpeed[i] * mSpeedScales[i] / FixedOne, dist - range);
+			mX[i] += (int32)(dx * move / dist);
+			mY[i] += (int32)(dy * move / dist);
+			continue;
+		}
+
+		if (mCooldowns[i] > 0)
+			continue;
+
+		int32 damage = mDamage[i];
+		if (mCritChance[i] > 0 && mRand.GetUnsignedInt() % FixedOne < mCritChance[i])
+			damage *= 2;
+
+		// Like the damage queue, hits are added up and applied together once everyone has acted
+		mPendingDamage[target] += damage;
+		if (mOnHitEffects[i] != INDEX_NONE)
+			ApplyEffect(target, mEffectDefs[mOnHitEffects[i]]);
+
+		mCooldowns[i] = mAttackTicks[i];
+	}
+
+	for (int i = 0; i < mTeams.Num(); i++)
+	{
+		if (mPendingDamage[i] == 0)
+			continue;
+
+		if (CombatRules::ApplyDamage(mHealth[i], mPendingDamage[i]))
+			mNumAlive--;
+
+		mPendingDamage[i] = 0;
+	}
+
+	mTick++;
+	mChecksum = FCrc::MemCrc32(mHealth.GetData(), mHealth.Num() * sizeof(int32), mChecksum);
+	mChecksum = FCrc::MemCrc32(mX.GetData(), mX.Num() * sizeof(int32), mChecksum);
+	mChecksum = FCrc::MemCrc32(mY.GetData(), mY.Num() * sizeof(int32), mChecksum);
+}
+
+FCombatSimResult FCombatSim::RunRound(int maxTicks)
+{
+	while (mTick < maxTicks && GetWinningTeam() == INDEX_NONE && mNumAlive > 0)
+	{
+		Step();
+	}
+
+	FCombatSimResult result;
+	result.WinningTeam = GetWinningTeam();
+	result.Ticks = mTick;
+	result.NumAlive = mNumAlive;
+	result.Checksum = mChecksum;
+	return result;
+}
+
+int FCombatSim::GetWinningTeam() const
+{
+	int winner = INDEX_NONE;
+	for (int i = 0; i < mTeams.Num(); i++)
+	{
+		if (mHealth[i] <= 0)
+			continue;
+
+		if (winner != INDEX_NONE && mTeams[i] != winner)
+			return INDEX_NONE;
+
+		winner = mTeams[i];
+	}
+
+	return winner;
+}
+
+int FCombatSim::FindTarget(int unit) const
+{
+	int best = INDEX_NONE;
+	int64 bestDistSq = MAX_int64;
+
+	for (int i = 0; i < mTeams.Num(); i++)
+	{
+		if (mHealth[i] <= 0 || mTeams[i] == mTeams[unit])
+			continue;
+
+		int64 dx = (int64)mX[i] - mX[unit];
+		int64 dy = (int64)mY[i] - mY[unit];
+		int64 distSq = dx * dx + dy * dy;
+		if (distSq < bestDistSq)
+		{
+			best = i;
+			bestDistSq = distSq;
+		}
+	}
+
+	return best;
+}
+
+void FCombatSim::ApplyEffect(int unit, const FSimEffect& effect)
+{
+	int found = INDEX_NONE;
+	int stacks = 0;
+	for (int i = 0; i < mEffectUnits.Num(); i++)
+	{
+		if (mEffectUnits[i] != unit || mEffectIds[i] != effect.Id)
+			continue;
+
+		if (found == INDEX_NONE)
+			found = i;
+		stacks += mEffectStacks[i];
+	}
+
+	bool addRow = found == INDEX_NONE || (effect.Stacking == STACK_INDEPENDENT && stacks < effect.MaxStacks);
+	if (addRow)
+	{
+		mEffectUnits.Add(unit);
+		mEffectIds.Add(effect.Id);
+		mEffectRates.Add(effect.RatePerTick);
+		mEffectSpeeds.Add(effect.SpeedMultiplier);
+		mEffectStacks.Add(1);
+		mEffectTicksLeft.Add(effect.Ticks);
+		return;
+	}
+
+	switch (effect.Stacking)
+	{
+	case STACK_INTENSITY:
+		mEffectStacks[found] = CombatRules::AddStack(mEffectStacks[found], effect.MaxStacks);
+		break;
+
+	case STACK_INDEPENDENT:
+		mEffectRates[found] = effect.RatePerTick;
+		mEffectSpeeds[found] = effect.SpeedMultiplier;
+		break;
+
+	default:
+		CombatRules::KeepStronger(mEffectRates[found], effect.RatePerTick, 0);
+		CombatRules::KeepStronger(mEffectSpeeds[found], effect.SpeedMultiplier, FixedOne);
+		break;
+	}
+
+	mEffectTicksLeft[found] = effect.Ticks;
+}
+
+void FCombatSim::StepEffects()
+{
+	for (int i = 0; i < mTeams.Num(); i++)
+	{
+		mHealthDeltas[i] = 0;
+		mSpeedScales[i] = FixedOne;
+	}
+
+	for (int i = mEffectUnits.Num() - 1; i >= 0; i--)
+	{
+		int unit = mEffectUnits[i];
+		mHealthDeltas[unit] += mEffectRates[i] * mEffectStacks[i];
+
+		for (int stack = 0; stack < mEffectStacks[i]; stack++)
+		{
+			mSpeedScales[unit] = (int32)((int64)mSpeedScales[unit] * mEffectSpeeds[i] / FixedOne);
+		}
+
+		if (mEffectTicksLeft[i] < 0)
+			continue;
+
+		// The tick an effect runs out on still counts, the same as the status effect subsystem
+		if (--mEffectTicksLeft[i] <= 0)
+		{
+			mEffectUnits.RemoveAtSwap(i, 1, false);
+			mEffectIds.RemoveAtSwap(i, 1, false);
+			mEffectRates.RemoveAtSwap(i, 1, false);
+			mEffectSpeeds.RemoveAtSwap(i, 1, false);
+			mEffectStacks.RemoveAtSwap(i, 1, false);
+			mEffectTicksLeft.RemoveAtSwap(i, 1, false);
+		}
+	}
+}
+
+int64 FCombatSim::SquareRoot(int64 value)
+{
+	if (value <= 0)
+		return 0;
+
+	// The estimate is corrected to the exact floor, so the answer doesn't depend on how the platform rounds
+	int64 root = (int64)FMath::Sqrt((double)value);
+	while (root * root > value)
+	{
+		root--;
+	}
+	while ((root + 1) * (root + 1) <= value)
+	{
+		root++;
+	}
+
+	return root;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file CombatSimCommandlet.cpp
+ * @brief Defines a commandlet that batch runs headless combat rounds for balance and soak testing
+ * @dependencies Commandlet.h, CombatSim.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "CombatSimCommandlet.h"
+#include "CombatSim.h"
+#include "Misc/Parse.h"
+#include "Misc/Crc.h"
+
+UCombatSimCommandlet::UCombatSimCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+/** @brief Sets up one round, the same seed always gives the same round
+ */
+static void SetupRound(FCombatSim& sim, int seed, int numPlayers, int numGrunts, int numGladiators)
+{
+	// Roughly the class defaults, blueprints may tune these further
+	FSimUnitDef player;
+	player.Team = 0;
+	player.MaxHealth = 1000.0f;
+	player.Damage = 25.0f;
+	player.AttackInterval = 0.5f;
+	player.Range = 200.0f;
+	player.Speed = 600.0f;
+	player.CritChance = 0.1f;
+
+	FSimUnitDef grunt;
+	grunt.Team = 1;
+	grunt.MaxHealth = 100.0f;
+	grunt.Damage = 10.0f;
+	grunt.AttackInterval = 1.0f;
+	grunt.Range = 150.0f;
+	grunt.Speed = 400.0f;
+
+	FSimUnitDef gladiator;
+	gladiator.Team = 1;
+	gladiator.MaxHealth = 500.0f;
+	gladiator.Damage = 40.0f;
+	gladiator.AttackInterval = 2.0f;
+	gladiator.Range = 250.0f;
+	gladiator.Speed = 450.0f;
+	gladiator.OnHitEffect.EffectId = TEXT("Burn");
+	gladiator.OnHitEffect.HealthPerSecond = -5.0f;
+	gladiator.OnHitEffect.Duration = 3.0f;
+	gladiator.OnHitEffect.Stacking = STACK_INTENSITY;
+	gladiator.OnHitEffect.MaxStacks = 3;
+
+	sim.Reset(seed);
+	sim.AddGroup(player, numPlayers, FVector2D(0.0f, 0.0f), 300.0f);
+	sim.AddGroup(grunt, numGrunts, FVector2D(2500.0f, 0.0f), 1000.0f);
+	sim.AddGroup(gladiator, numGladiators, FVector2D(3000.0f, 0.0f), 200.0f);
+}
+
+int32 UCombatSimCommandlet::Main(const FString& Params)
+{
+	int numRounds = 1000;
+	int seed = 1;
+	int numPlayers = 4;
+	int numGrunts = 24;
+	int numGladiators = 1;
+	float seconds = 180.0f;
+
+	FParse::Value(*Params, TEXT("rounds="), numRounds);
+	FParse::Value(*Params, TEXT("seed="), seed);
+	FParse::Value(*Params, TEXT("players="), numPlayers);
+	FParse::Value(*Params, TEXT("grunts="), numGrunts);
+	FParse::Value(*Params, TEXT("gladiators="), numGladiators);
+	FParse::Value(*Params, TEXT("seconds="), seconds);
+
+	const int tickRate = 30;
+	int maxTicks = FMath::CeilToInt(seconds * tickRate);
+	FCombatSim sim(tickRate);
+
+	// The same round twice has to come out the same
+	SetupRound(sim, seed, numPlayers, numGrunts, numGladiators);
+	FCombatSimResult first = sim.RunRound(maxTicks);
+	SetupRound(sim, seed, numPlayers, numGrunts, numGladiators);
+	FCombatSimResult second = sim.RunRound(maxTicks);
+
+	if (first.Checksum != second.Checksum || first.Ticks != second.Ticks)
+	{
+		GLog->Logf(ELogVerbosity::Error, TEXT("CombatSim: seed %d is not deterministic (%08x after %d ticks, then %08x after %d ticks)"),
+			seed, first.Checksum, first.Ticks, second.Checksum, second.Ticks);
+		return 1;
+	}
+
+	int wins[2] = { 0, 0 };
+	int timeouts = 0;
+	int64 totalTicks = 0;
+	uint32 checksum = 0;
+
+	double start = FPlatformTime::Seconds();
+	for (int round = 0; round < numRounds; round++)
+	{
+		SetupRound(sim, seed + round, numPlayers, numGrunts, numGladiators);
+		FCombatSimResult result = sim.RunRound(maxTicks);
+
+		if (result.WinningTeam == 0 || result.WinningTeam == 1)
+			wins[result.WinningTeam]++;
+		else
+			timeouts++;
+
+		totalTicks += result.Ticks;
+		checksum = FCrc::MemCrc32(&result.Checksum, sizeof(uint32), checksum);
+	}
+	double elapsed = FMath::Max(FPlatformTime::Seconds() - start, 0.000001);
+
+	int rounds = FMath::Max(numRounds, 1);
+	GLog->Logf(ELogVerbosity::Display, TEXT("CombatSim: %d rounds of %d players vs %d grunts and %d gladiators, seeds %d to %d"),
+		numRounds, numPlayers, numGrunts, numGladiators, seed, seed + numRounds - 1);
+	GLog->Logf(ELogVerbosity::Display, TEXT("  Players won %d (%.1f%%), enemies won %d (%.1f%%), out of time %d"),
+		wins[0], 100.0f * wins[0] / rounds, wins[1], 100.0f * wins[1] / rounds, timeouts);
+	GLog->Logf(ELogVerbosity::Display, TEXT("  Average round %.1fs, %.0f rounds per second, %.0f ticks per second"),
+		(float)totalTicks / rounds / tickRate, numRounds / elapsed, totalTicks / elapsed);
+	GLog->Logf(ELogVerbosity::Display, TEXT("  Checksum %08x"), checksum);
+
+	return 0;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file CrowdAvoidanceSubsystem.cpp
+ * @brief Defines a world subsystem that steers crowds of grunts around each other in one parallel pass
+ * @dependencies WorldSubsystem.h, Tickable.h, ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ *	https://gamma.cs.unc.edu/RVO/
+ **/
+
+#include "CrowdAvoidanceSubsystem.h"
+#include "ArenaGrid.h"
+#include "BaseUnit.h"
+#include "Async/ParallelFor.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+
+UCrowdAvoidanceSubsystem::UCrowdAvoidanceSubsystem()
+{
+	// Overridden by DefaultGame.ini
+	TimeHorizon = 1.0f;
+	Separation = 20.0f;
+	AvoidanceStrength = 1.0f;
+
+	ParallelThreshold = 32;
+
+	mpArena = nullptr;
+}
+
+UCrowdAvoidanceSubsystem* UCrowdAvoidanceSubsystem::Get(const UObject* worldContextObject)
+{
+	UWorld* world = worldContextObject ? worldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UCrowdAvoidanceSubsystem>() : nullptr;
+}
+
+void UCrowdAvoidanceSubsystem::Deinitialize()
+{
+	mAgents.Empty();
+	mPositions.Empty();
+	mVelocities.Empty();
+	mRadii.Empty();
+	mTiles.Empty();
+	mAvoidance.Empty();
+	mpArena = nullptr;
+
+	Super::Deinitialize();
+}
+
+void UCrowdAvoidanceSubsystem::Tick(float DeltaTime)
+{
+	if (!IsValid(mpArena))
+		mpArena = AArenaGrid::FindArena(this);
+
+	if (!mpArena)
+		return;
+
+	GatherAgents();
+	ComputeAvoidance();
+}
+
+bool UCrowdAvoidanceSubsystem::IsTickable() const
+{
+	return !IsTemplate() && mAgents.Num() > 0;
+}
+
+UWorld* UCrowdAvoidanceSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UCrowdAvoidanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCrowdAvoidanceSubsystem, STATGROUP_Tickables);
+}
+
+void UCrowdAvoidanceSubsystem::RegisterAgent(ABaseUnit* unit)
+{
+	if (!unit || (mAgents.IsValidIndex(unit->mAvoidanceHandle) && mAgents[unit->mAvoidanceHandle] == unit))
+		return;
+
+	unit->mAvoidanceHandle = mAgents.Add(unit);
+	mPositions.Add(unit->GetActorLocation());
+	mVelocities.Add(FVector::ZeroVector);
+	mRadii.Add(unit->GetCapsuleComponent()->GetScaledCapsuleRadius());
+	mTiles.Add(INDEX_NONE);
+	mAvoidance.Add(FVector::ZeroVector);
+}
+
+void UCrowdAvoidanceSubsystem::UnregisterAgent(ABaseUnit* unit)
+{
+	if (!unit || !mAgents.IsValidIndex(unit->mAvoidanceHandle) || mAgents[unit->mAvoidanceHandle] != unit)
+		return;
+
+	int handle = unit->mAvoidanceHandle;
+	unit->mAvoidanceHandle = INDEX_NONE;
+
+	// Nothing walks the arrays outside of Tick, so they can be compacted straight away
+	mAgents.RemoveAtSwap(handle, 1, false);
+	mPositions.RemoveAtSwap(handle, 1, false);
+	mVelocities.RemoveAtSwap(handle, 1, false);
+	mRadii.RemoveAtSwap(handle, 1, false);
+	mTiles.RemoveAtSwap(handle, 1, false);
+	mAvoidance.RemoveAtSwap(handle, 1, false);
+
+	if (mAgents.IsValidIndex(handle))
+		mAgents[handle]->mAvoidanceHandle = handle;
+}
+
+void UCrowdAvoidanceSubsystem::GatherAgents()
+{
+	for (int i = 0; i < mAgents.Num(); i++)
+	{
+		ABaseUnit* agent = mAgents[i];
+		mPositions[i] = agent->GetActorLocation();
+		mVelocities[i] = agent->GetVelocity();
+		mTiles[i] = agent->mCurrentTile;
+	}
+}
+
+void UCrowdAvoidanceSubsystem::ComputeAvoidance()
+{
+	// Only reads the arena and the gathered arrays, so every agent can be worked out on its own thread
+	ParallelFor(mAgents.Num(), [this](int32 i)
+	{
+		mAvoidance[i] = ComputeAgentAvoidance(i);
+	}, mAgents.Num() < ParallelThreshold);
+}
+
+FVector UCrowdAvoidanceSubsystem::ComputeAgentAvoidance(int agent) const
+{
+	if (mTiles[agent] == INDEX_NONE || TimeHorizon <= 0.0f)
+		return FVector::ZeroVector;
+
+	const FVector& position = mPositions[agent];
+	const FVector& velocity = mVelocities[agent];
+	const ABaseUnit* self = mAgents[agent];
+	FVector avoidance = FVector::ZeroVector;
+
+	mpArena->ForEachTileInRange(mTiles[agent], 1, [&](int tile)
+	{
+		for (int handle : mpArena->Occupancy.GetTileUnits(tile))
+		{
+			const ABaseUnit* other = mpArena->Occupancy.GetUnit(handle);
+			if (!other || other == self)
+				continue;
+
+			// Agents use this frame's gathered state, anything else (players, gladiators) is read directly
+			FVector otherPosition;
+			FVector otherVelocity;
+			float otherRadius;
+			if (mAgents.IsValidIndex(other->mAvoidanceHandle) && mAgents[other->mAvoidanceHandle] == other)
+			{
+				otherPosition = mPositions[other->mAvoidanceHandle];
+				otherVelocity = mVelocities[other->mAvoidanceHandle];
+				otherRadius = mRadii[other->mAvoidanceHandle];
+			}
+			else
+			{
+				otherPosition = other->GetActorLocation();
+				otherVelocity = other->GetVelocity();
+				otherRadius = other->GetCapsuleComponent()->GetScaledCapsuleRadius();
+			}
+
+			// Everything happens on the ground plane
+			FVector2D relPosition(otherPosition.X - position.X, otherPosition.Y - position.Y);
+			FVector2D relVelocity(otherVelocity.X - velocity.X, otherVelocity.Y - velocity.Y);
+			float combinedRadius = mRadii[agent] + otherRadius + Separation;
+
+			// Time until the two are closest if neither changes course
+			float relSpeedSq = relVelocity.SizeSquared();
+			float t = relSpeedSq > KINDA_SMALL_NUMBER ? FMath::Clamp(-FVector2D::DotProduct(relPosition, relVelocity) / relSpeedSq, 0.0f, TimeHorizon) : 0.0f;
+
+			FVector2D closest = relPosition + relVelocity * t;
+			float closestDist = closest.Size();
+			if (closestDist >= combinedRadius)
+				continue;
+
+			// Steer away from where the other unit will be, harder the sooner and deeper the overlap.
+			// Units stacked on the same spot are pushed apart along their current offset
+			FVector2D away = closestDist > KINDA_SMALL_NUMBER ? -closest / closestDist : -relPosition.GetSafeNormal();
+			float urgency = (1.0f - t / TimeHorizon) * (combinedRadius - closestDist) / combinedRadius;
+
+			avoidance += FVector(away.X, away.Y, 0.0f) * urgency * combinedRadius / TimeHorizon;
+		}
+	});
+
+	return avoidance * AvoidanceStrength;
+}
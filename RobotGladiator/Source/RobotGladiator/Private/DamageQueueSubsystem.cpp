@@ -0,0 +1,116 @@
+/**
+ * @file DamageQueueSubsystem.cpp
+ * @brief Defines a world subsystem that collects the hits dealt during a frame and applies them all at once
+ * @dependencies WorldSubsystem.h, Tickable.h, BaseUnit.h, CombatRules.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "DamageQueueSubsystem.h"
+#include "BaseUnit.h"
+#include "CombatRules.h"
+#include "Engine/World.h"
+
+UDamageQueueSubsystem::UDamageQueueSubsystem()
+{
+}
+
+UDamageQueueSubsystem* UDamageQueueSubsystem::Get(const UObject* worldContextObject)
+{
+	UWorld* world = worldContextObject ? worldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UDamageQueueSubsystem>() : nullptr;
+}
+
+void UDamageQueueSubsystem::Deinitialize()
+{
+	mTargets.Empty();
+	mDamage.Empty();
+	mTargetIndices.Empty();
+	mKilled.Empty();
+
+	Super::Deinitialize();
+}
+
+void UDamageQueueSubsystem::Tick(float DeltaTime)
+{
+	ResolveDamage();
+}
+
+bool UDamageQueueSubsystem::IsTickable() const
+{
+	return !IsTemplate() && mTargets.Num() > 0;
+}
+
+UWorld* UDamageQueueSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UDamageQueueSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDamageQueueSubsystem, STATGROUP_Tickables);
+}
+
+bool UDamageQueueSubsystem::QueueDamage(ABaseUnit* target, float damage, ABaseUnit* instigator)
+{
+	if (!IsValid(target) || !target->mIsActive || damage <= 0.0f)
+		return false;
+
+	// Only the server's health counts, a client resolving its own hits would kill units the server still has alive
+	if (!target->HasAuthority())
+		return false;
+
+	// Who hit whom is only known here, the totals below lose it
+	if (instigator)
+		target->ReceiveDamageFrom(instigator, damage);
+
+	int* index = mTargetIndices.Find(target);
+	if (!index)
+	{
+		index = &mTargetIndices.Add(target, mTargets.Add(target));
+		mDamage.Add(0.0f);
+	}
+
+	// Only the hit that takes the unit from alive to dead counts as the kill
+	float healthBefore = target->mHealth - mDamage[*index];
+	mDamage[*index] += damage;
+
+	return healthBefore > 0.0f && healthBefore - damage <= 0.0f;
+}
+
+float UDamageQueueSubsystem::GetPendingDamage(const ABaseUnit* target) const
+{
+	const int* index = mTargetIndices.Find(target);
+	return index ? mDamage[*index] : 0.0f;
+}
+
+void UDamageQueueSubsystem::ResolveDamage()
+{
+	mKilled.Reset();
+
+	// Change every target's health once, in the order they were first hit
+	for (int i = 0; i < mTargets.Num(); i++)
+	{
+		ABaseUnit* target = mTargets[i];
+		if (!IsValid(target) || !target->mIsActive)
+			continue;
+
+		// Same rule the combat simulation uses, so its results hold for the game
+		if (CombatRules::ApplyDamage(target->mHealth, mDamage[i]))
+			mKilled.Add(target);
+	}
+
+	// Empty the queue before anyone dies so hits dealt by death effects land next frame
+	mTargets.Reset();
+	mDamage.Reset();
+	mTargetIndices.Reset();
+
+	for (ABaseUnit* unit : mKilled)
+	{
+		if (IsValid(unit))
+			unit->Die();
+	}
+
+	mKilled.Reset();
+}
@@ -10,6 +10,9 @@
  **/
 
 #include "GladiatorBase.h"
+#include "ProjectileSubsystem.h"
+#include "PlayerRegistrySubsystem.h"
+#include "UnitAIManager.h"
 #include "Kismet/GameplayStatics.h"
 #include "Misc/OutputDevice.h"
 
@@ -20,116 +23,241 @@ AGladiatorBase::AGladiatorBase()
 	mTimeLeftOnCoolDown = 6;
 	mIsOnCooldown = true;
 	mHealth = 50.0f;
+
+	mDamageThreatScale = 1.0f;
+	mProximityThreatPerSecond = 5.0f;
+	mThreatRadius = 1500.0f;
+	mThreatDecayPerSecond = 0.1f;
+	mThreatUpdateInterval = 0.5f;
+	mTargetSwitchRatio = 1.2f;
+	mLastThreatUpdateTime = 0.0f;
 }
 
 void AGladiatorBase::BeginPlay()
 {
 	Super::BeginPlay();
 
+	mLastThreatUpdateTime = GetWorld()->GetTimeSeconds();
+
 	if (mpTarget == nullptr)
 	{
+		mpTarget = FindClosestPlayer(mClasstoFind);
+	}
+}
+
+/**   @brief Called every frame
+ *	  @param {float} deltaTime - time elapsed since last tick call
+ *    @return {void} - null
+ */
+void AGladiatorBase::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// With mUseNativeAI set, target selection, cooldowns and attack decisions are made by the UUnitAIManager,
+	// otherwise the blueprint's behaviour tree makes them
+}
+
+/**   @brief Store the AI manager's state in the blueprint visible properties
+ *	  @param {AActor*} target - the current target
+ *	  @param {float} distance - distance to the target
+ *	  @param {float} cooldown - time left before the next attack
+ *    @return {void} - null
+ */
+void AGladiatorBase::ReceiveAIState(AActor* target, float distance, float cooldown)
+{
+	mpTarget = target;
+	mDistanceToTarget = distance;
+	mTimeLeftOnCoolDown = cooldown;
+	mIsOnCooldown = cooldown > 0.0f;
+
+	// Thinking is already throttled by the AI manager, threat rides along with it
+	UpdateThreat();
+}
 
-		TArray<AActor*> foundActors;
-		UGameplayStatics::GetAllActorsOfClass(GetWorld(), mClasstoFind, foundActors);
+/**   @brief The gladiator is busy while an attack is playing out
+ *    @return {bool} - true while attacking
+ */
+bool AGladiatorBase::IsAIBusy() const
+{
+	return mIsAttacking;
+}
 
-		mpTarget = GetClosestPlayer(foundActors);
+/**   @brief Melee the target if it is in range, otherwise shoot at it
+ *	  @param {float} distance - distance to the target
+ *    @return {float} - cooldown of the attack that was used
+ */
+float AGladiatorBase::PerformAIAction(float distance)
+{
+	if (distance <= mMeleeRange)
+	{
+		MeleeAttack();
+		return mMeleeCoolDown;
 	}
+
+	//add function to get farthest player from gladiator
+	RangedAttack();
+	return mRangedCoolDownTime;
+}
+
+/**   @brief The gladiator waits out its starting cooldown before attacking
+ *    @return {float} - the starting cooldown
+ */
+float AGladiatorBase::GetAIStartCooldown() const
+{
+	return mTimeLeftOnCoolDown;
+}
+
+/**   @brief The gladiator only targets mClasstoFind
+ *    @return {TSubclassOf<AActor>} - the class to target
+ */
+TSubclassOf<AActor> AGladiatorBase::GetAITargetClass() const
+{
+	return mClasstoFind;
+}
+
+/**   @brief Clear the target and attack state of a pooled gladiator being reused
+ *    @return {void} - null
+ */
+void AGladiatorBase::ResetUnit()
+{
+	Super::ResetUnit();
+
+	mpTarget = nullptr;
+	mIsAttacking = false;
+	mThreatTable.Reset();
+	mLastThreatUpdateTime = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.0f;
+
+	// Start on the same cooldown a freshly spawned gladiator would
+	const AGladiatorBase* defaults = GetClass()->GetDefaultObject<AGladiatorBase>();
+	mTimeLeftOnCoolDown = defaults->mTimeLeftOnCoolDown;
+	mIsOnCooldown = defaults->mIsOnCooldown;
+}
+
+/**   @brief Keep the current target while the gladiator has a threat table, the table decides when it changes
+ *    @return {AActor*} - the target to use, nullptr to go for the closest player
+ */
+AActor* AGladiatorBase::ChooseAITarget()
+{
+	if (mThreatTable.Num() == 0)
+		return nullptr;
+
+	return IsValid(mpTarget) ? mpTarget : mThreatTable.GetTop();
+}
+
+/**   @brief Adds threat for a player that hit the gladiator
+ *	  @param {ABaseUnit*} instigator - the unit that dealt the damage
+ *	  @param {float} damage - the damage dealt
+ *    @return {void} - null
+ */
+void AGladiatorBase::ReceiveDamageFrom(ABaseUnit* instigator, float damage)
+{
+	if (!instigator->mIsPlayerUnit || (mClasstoFind && !instigator->IsA(mClasstoFind)))
+		return;
+
+	mThreatTable.AddThreat(instigator, damage * mDamageThreatScale);
+	UpdateThreatTarget();
+}
+
+/**   @brief Gets the players the gladiator is most angry at
+ *	  @param {int} count - how many players to get
+ *    @return {TArray<AActor*>} - up to count players, most threat first
+ */
+TArray<AActor*> AGladiatorBase::GetTopThreats(int count) const
+{
+	TArray<AActor*> threats;
+	mThreatTable.GetTopK(count, threats);
+	return threats;
 }
 
-/**   @brief Get the closes player to the gladiator
- *	  @param {TArray<AActor*>} Array - array of actors to choose from - 
- *    @return {AActor*} - the closest player to the gladiator
+/**   @brief Gets how much threat a player has built up against the gladiator
+ *	  @param {AActor*} player - the player to check
+ *    @return {float} - the player's threat
  */
-AActor* AGladiatorBase::GetClosestPlayer(TArray<AActor*> Array)
+float AGladiatorBase::GetThreat(const AActor* player) const
+{
+	return mThreatTable.GetThreat(player);
+}
+
+void AGladiatorBase::UpdateThreat()
 {
-	AActor* closestPlayer = nullptr;
-	float distance = INT_MAX;
+	float now = GetWorld()->GetTimeSeconds();
+	float elapsed = now - mLastThreatUpdateTime;
+	if (elapsed < mThreatUpdateInterval)
+		return;
 
+	mLastThreatUpdateTime = now;
 
-	//find the closes actor
-	for (AActor* actor : Array)
+	// Every value decays by the same factor so this is one multiply no matter how many players there are
+	mThreatTable.Decay(FMath::Pow(1.0f - FMath::Clamp(mThreatDecayPerSecond, 0.0f, 1.0f), elapsed));
+
+	// The registry only holds the players, so this is a handful of distance checks
+	if (UPlayerRegistrySubsystem* registry = UPlayerRegistrySubsystem::Get(this))
 	{
-		if (actor != this)
+		FVector location = GetActorLocation();
+		for (AActor* player : registry->GetPlayers())
 		{
-			if (closestPlayer == nullptr)
-			{
-				closestPlayer = actor;
-				FVector dir = closestPlayer->GetActorLocation() - this->GetActorLocation();
-				distance = dir.Size();
-			}
-			else
-			{
-				FVector dir = actor->GetActorLocation() - this->GetActorLocation();
-
-				if (dir.SizeSquared() < distance * distance)
-				{
-					closestPlayer = actor;
-					distance = dir.Size();
-				}
-			}
+			if (!IsValid(player) || (mClasstoFind && !player->IsA(mClasstoFind)))
+				continue;
+
+			float distance = FVector::Dist(location, player->GetActorLocation());
+			if (distance < mThreatRadius)
+				mThreatTable.AddThreat(player, mProximityThreatPerSecond * elapsed * (1.0f - distance / mThreatRadius));
 		}
 	}
 
-	return closestPlayer;
+	// Forget players that left or haven't done anything for a long time
+	mThreatTable.RemoveStale(KINDA_SMALL_NUMBER);
+	UpdateThreatTarget();
 }
 
-/**   @brief Called every frame
- *	  @param {float} deltaTime - time elapsed since last tick call
+void AGladiatorBase::UpdateThreatTarget()
+{
+	AActor* top = mThreatTable.GetTop();
+	if (!top || top == mpTarget)
+		return;
+
+	// Only switch once the new player is clearly ahead, otherwise close players would flip the target back and forth
+	if (IsValid(mpTarget) && mThreatTable.GetThreat(top) < mThreatTable.GetThreat(mpTarget) * mTargetSwitchRatio)
+		return;
+
+	mpTarget = top;
+	if (UUnitAIManager* manager = UUnitAIManager::Get(this))
+		manager->SetTarget(this, top);
+}
+
+/**   @brief Fires a fan of native projectiles from the server
+ *	  @param {FVector} origin - where the projectiles start
+ *	  @param {FVector} direction - the direction of the middle projectile
+ *	  @param {int} count - how many projectiles to fire
+ *	  @param {float} spreadAngle - angle in degrees between the first and last projectile
+ *	  @param {float} speed - speed of each projectile
+ *	  @param {float} damage - damage dealt by each projectile
  *    @return {void} - null
  */
-void AGladiatorBase::Tick(float DeltaTime)
+void AGladiatorBase::FireProjectiles(FVector origin, FVector direction, int count, float spreadAngle, float speed, float damage)
 {
-	Super::Tick(DeltaTime);
+	if (!HasAuthority() || count <= 0)
+		return;
+
+	// One message for the whole fan, every machine fans the shots out itself
+	MulticastFireProjectiles(origin, direction.GetSafeNormal(), (uint8)FMath::Min(count, 255), spreadAngle, speed, damage);
+}
+
+/**   @brief Adds the projectiles to the projectile subsystem, only the server's copies deal damage
+ *    @return {void} - null
+ */
+void AGladiatorBase::MulticastFireProjectiles_Implementation(FVector_NetQuantize origin, FVector_NetQuantizeNormal direction, uint8 count, float spreadAngle, float speed, float damage)
+{
+	UProjectileSubsystem* projectiles = UProjectileSubsystem::Get(this);
+	if (!projectiles)
+		return;
+
+	float step = count > 1 ? spreadAngle / (count - 1) : 0.0f;
+	float start = count > 1 ? -spreadAngle * 0.5f : 0.0f;
 
-	//TArray<AActor*> foundActors;
-	//UGameplayStatics::GetAllActorsOfClass(GetWorld(), mClasstoFind, foundActors);
-	//AActor* target = GetClosestPlayer(foundActors);
-
-	//if (mpTarget == nullptr || (mpTarget != nullptr && target != mpTarget))
-	//{
-	//	mpTarget = target;
-
-	//	//UE_LOG(LogTemp, Warning, TEXT("Name: %s"), *(mpTarget->GetName()));
-
-	//	
-	//}
-	//else if(mpTarget != nullptr)
-	//{
-	//	FVector dir = mpTarget->GetActorLocation() - this->GetActorLocation();
-	//	mDistanceToTarget = dir.Size();
-	//}
-	//
-	//if ( !mIsOnCooldown && !mIsAttacking && mpTarget != nullptr)
-	//{
-	//
-
-	//	if (mDistanceToTarget <= mMeleeRange) 
-	//	{
-	//		MeleeAttack();
-	//		mTimeLeftOnCoolDown = mMeleeCoolDown;
-	//	}
-	//	else
-	//	{
-	//		//add function to get farthest player from gladiator
-
-	//		RangedAttack();
-	//		mTimeLeftOnCoolDown = mRangedCoolDownTime;
-
-	//	}
-
-	//	
-	//	//mIsOnCooldown = true;
-	//}
-	//else if (mIsOnCooldown)
-	//{
-	//	mTimeLeftOnCoolDown -= DeltaTime;
-	//	if (mTimeLeftOnCoolDown <= 0)
-	//	{
-	//		mTimeLeftOnCoolDown = 0;
-	//		mIsOnCooldown = false;
-	//	}
-	//}
-
-
-	////UE_LOG(LogTemp, Warning, TEXT("Cooldown: %s"), *(FString::SanitizeFloat(mTimeLeftOnCoolDown)));
+	for (int i = 0; i < count; i++)
+	{
+		FVector shotDirection = direction.RotateAngleAxis(start + step * i, FVector::UpVector);
+		projectiles->FireProjectile(origin, shotDirection * speed, damage, this, HasAuthority());
+	}
 }
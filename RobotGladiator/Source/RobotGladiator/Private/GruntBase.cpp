@@ -2,98 +2,72 @@
 
 
 #include "GruntBase.h"
+#include "GruntMovementComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Misc/OutputDevice.h"
 
-AGruntBase::AGruntBase()
+AGruntBase::AGruntBase(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UGruntMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	SetActorTickEnabled(true);
+
+	mpTarget = nullptr;
+	mMeleeRange = 150.0f;
+	mDistanceToTarget = 0.0f;
+	mMeleeCoolDown = 1.5f;
 }
 
 
 void AGruntBase::BeginPlay()
 {
 	Super::BeginPlay();
-
-	/*
-	if (mpTarget == nullptr)
-	{
-		TArray<AActor*> foundActors;
-		UGameplayStatics::GetAllActorsOfClass(GetWorld(), mClasstoFind, foundActors);
-
-		mpTarget = GetClosestPlayer(foundActors);
-	}
-	*/
-
 }
 
 void AGruntBase::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	/*
-	TArray<AActor*> foundActors;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), mClasstoFind, foundActors);
-	AActor* target = GetClosestPlayer(foundActors);
+	// With mUseNativeAI set, targeting and attacking are handled by the UUnitAIManager, otherwise by the blueprint
+}
 
+void AGruntBase::ReceiveAIState(AActor* target, float distance, float cooldown)
+{
 	//Get Nearest Target and Set it
-	if (mpTarget == nullptr || (mpTarget != nullptr && target != mpTarget))
-	{
-		mpTarget = target;
-	}
-	else if (mpTarget != nullptr)
-	{
-		FVector dir = mpTarget->GetActorLocation() - this->GetActorLocation();
-		mDistanceToTarget = dir.Size();
-	}
+	mpTarget = target;
+	mDistanceToTarget = distance;
+}
 
-	//Handle Attacking for Grunt
-	if (!mIsAttacking && mpTarget != nullptr)
+float AGruntBase::PerformAIAction(float distance)
+{
+	//Handle Attacking for Grunt, the AI manager's cooldown covers the swing so the blueprint doesn't have to report back
+	if (distance <= mMeleeRange)
 	{
-		if (mDistanceToTarget <= mMeleeRange)
-		{
-			MeleeAttack();
-			mIsAttacking = true;
-		}
+		MeleeAttack();
+		return mMeleeCoolDown;
 	}
 
-
-	*/
+	return -1.0f;
 }
 
-//Used Fosters Code for getting closest player
+//Kept as an exec node for the grunt controller, the search itself is shared with every unit
 AActor* AGruntBase::GetClosestPlayer(TArray<AActor*> Array)
 {
-	AActor* closestPlayer = nullptr; 
-	float distance = INT_MAX;
-
+	return ABaseUnit::GetClosestPlayer(Array);
+}
 
-	//find the closes actor
-	for (AActor* actor : Array)
-	{
-		if (actor != this)
-		{
-			if (closestPlayer == nullptr)
-			{
-				closestPlayer = actor;
-				FVector dir = closestPlayer->GetActorLocation() - this->GetActorLocation();
-				distance = dir.Size();
-			}
-			else
-			{
-				FVector dir = actor->GetActorLocation() - this->GetActorLocation();
-
-				if (dir.SizeSquared() < distance * distance)
-				{
-					closestPlayer = actor;
-					distance = dir.Size();
-					// mDistanceToTarget = distance;
-				}
-			}
-		}
-	}
+void AGruntBase::ResetUnit()
+{
+	Super::ResetUnit();
 
+	mpTarget = nullptr;
+	mDistanceToTarget = 0.0f;
+}
 
-	return closestPlayer;
+void AGruntBase::SetAILOD(EAILODTier tier, float movementTickInterval)
+{
+	Super::SetAILOD(tier, movementTickInterval);
 
-}
\ No newline at end of file
+	// Nobody is close enough to notice the simplified movement
+	if (UGruntMovementComponent* movement = Cast<UGruntMovementComponent>(GetCharacterMovement()))
+		movement->SetSimplifiedMovement(tier == AI_LOD_FAR);
+}
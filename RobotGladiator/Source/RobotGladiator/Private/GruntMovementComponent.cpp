@@ -0,0 +1,133 @@
+/**
+ * @file GruntMovementComponent.cpp
+ * @brief Defines the movement component used by grunts, which takes its avoidance from the crowd avoidance subsystem
+ *		and has a cheap flow field movement mode for grunts far away from every player
+ * @dependencies UnitMovementComponent.h, CrowdAvoidanceSubsystem.h, ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "GruntMovementComponent.h"
+#include "ArenaGrid.h"
+#include "BaseUnit.h"
+#include "CrowdAvoidanceSubsystem.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/Character.h"
+
+UGruntMovementComponent::UGruntMovementComponent()
+{
+	// Makes CalcVelocity call CalcAvoidanceVelocity
+	bUseRVOAvoidance = true;
+
+	mWantsSimplifiedMovement = false;
+}
+
+float UGruntMovementComponent::GetMaxSpeed() const
+{
+	if (!IsUsingSimplifiedMovement())
+		return Super::GetMaxSpeed();
+
+	// Switching AI LOD tier shouldn't change how fast the grunt goes, or drop its slows
+	const ABaseUnit* unit = Cast<ABaseUnit>(CharacterOwner);
+	return unit ? MaxWalkSpeed * unit->mSpeedScale : MaxWalkSpeed;
+}
+
+void UGruntMovementComponent::CalcAvoidanceVelocity(float DeltaTime)
+{
+	ABaseUnit* unit = Cast<ABaseUnit>(GetOwner());
+	UCrowdAvoidanceSubsystem* crowd = UCrowdAvoidanceSubsystem::Get(this);
+	if (!unit || !crowd || unit->mAvoidanceHandle == INDEX_NONE || !IsMovingOnGround())
+		return;
+
+	FVector avoidance = crowd->GetAvoidance(unit->mAvoidanceHandle);
+	if (avoidance.IsNearlyZero())
+		return;
+
+	// Steer, but never faster than the grunt can move
+	Velocity = (Velocity + avoidance).GetClampedToMaxSize2D(GetMaxSpeed());
+}
+
+void UGruntMovementComponent::SetSimplifiedMovement(bool enable)
+{
+	mWantsSimplifiedMovement = enable;
+	if (enable == IsUsingSimplifiedMovement())
+		return;
+
+	// Only grunts already on the ground can switch, jumping and falling finish with the full movement first and
+	// switch when they land
+	if (enable && IsMovingOnGround() && IsOverArena())
+		SetMovementMode(MOVE_Custom, CUSTOM_FLOW_FIELD);
+	else if (!enable)
+		SetMovementMode(MOVE_Walking);
+}
+
+void UGruntMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+
+	// Landing puts the grunt back to walking. Grunts off the grid stay walking, or they would drop straight back out
+	if (mWantsSimplifiedMovement && MovementMode == MOVE_Walking && IsOverArena())
+		SetMovementMode(MOVE_Custom, CUSTOM_FLOW_FIELD);
+}
+
+bool UGruntMovementComponent::IsOverArena() const
+{
+	ABaseUnit* unit = Cast<ABaseUnit>(CharacterOwner);
+	AArenaGrid* arena = unit ? unit->mpArena : nullptr;
+	return arena && UpdatedComponent && arena->GetTileAtLocation(UpdatedComponent->GetComponentLocation()) != INDEX_NONE;
+}
+
+void UGruntMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
+{
+	if (CustomMovementMode == CUSTOM_FLOW_FIELD)
+	{
+		PhysFlowField(deltaTime, Iterations);
+		return;
+	}
+
+	Super::PhysCustom(deltaTime, Iterations);
+}
+
+void UGruntMovementComponent::PhysFlowField(float deltaTime, int32 Iterations)
+{
+	if (deltaTime < MIN_TICK_TIME || !CharacterOwner || !UpdatedComponent)
+		return;
+
+	ABaseUnit* unit = Cast<ABaseUnit>(CharacterOwner);
+	AArenaGrid* arena = unit ? unit->mpArena : nullptr;
+	FVector location = UpdatedComponent->GetComponentLocation();
+	int tile = arena ? arena->GetTileAtLocation(location) : INDEX_NONE;
+
+	// Off the grid there are no heights to snap to, so go back to the full movement
+	if (tile == INDEX_NONE)
+	{
+		SetMovementMode(MOVE_Falling);
+		StartNewPhysics(deltaTime, Iterations);
+		return;
+	}
+
+	// Wait in place if no player can be reached, or once the player's tile is reached
+	int nextTile = arena->FlowField.GetNextTile(tile);
+	if (nextTile == INDEX_NONE || nextTile == tile)
+	{
+		Velocity = FVector::ZeroVector;
+		return;
+	}
+
+	FVector toNext = arena->GetTileCenter(nextTile) - location;
+	toNext.Z = 0.0f;
+
+	float distance = toNext.Size();
+	float speed = GetMaxSpeed();
+	FVector direction = distance > KINDA_SMALL_NUMBER ? toNext / distance : FVector::ZeroVector;
+	Velocity = direction * speed;
+
+	// Move flat along the ground, then stand on top of whichever tile that lands on
+	FVector newLocation = location + direction * FMath::Min(speed * deltaTime, distance);
+	int newTile = arena->GetTileAtLocation(newLocation);
+	float halfHeight = CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	newLocation.Z = arena->GetTileSurfaceHeight(newTile != INDEX_NONE ? newTile : tile) + halfHeight;
+
+	MoveUpdatedComponent(newLocation - location, UpdatedComponent->GetComponentQuat(), false);
+}
@@ -125,3 +125,30 @@ HexCell GetNeighbor(HexCell cell, int face)
 {
 	return AddHex(cell, GetHexDirection(face));
 }
+
+/*
+* HexRound
+* Rounds fractional cube coordinates to the nearest cell
+*	- Param q, r, s: The fractional cube coordinates (q + r + s should be ~0)
+* Returns the HexCell containing the fractional point
+*/
+HexCell HexRound(float q, float r, float s)
+{
+	int roundQ = FMath::RoundToInt(q);
+	int roundR = FMath::RoundToInt(r);
+	int roundS = FMath::RoundToInt(s);
+
+	float diffQ = FMath::Abs(roundQ - q);
+	float diffR = FMath::Abs(roundR - r);
+	float diffS = FMath::Abs(roundS - s);
+
+	// Reset the component with the largest rounding error so that q + r + s stays 0
+	if (diffQ > diffR && diffQ > diffS)
+		roundQ = -roundR - roundS;
+	else if (diffR > diffS)
+		roundR = -roundQ - roundS;
+	else
+		roundS = -roundQ - roundR;
+
+	return HexCell(roundQ, roundR, roundS);
+}
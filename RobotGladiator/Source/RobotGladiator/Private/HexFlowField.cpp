@@ -0,0 +1,62 @@
+/**
+ * @file HexFlowField.cpp
+ * @brief Defines a flow field over the arena tiles that points every tile towards the nearest goal tile
+ * @dependencies ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ *	https://www.redblobgames.com/pathfinding/tower-defense/
+ **/
+
+#include "HexFlowField.h"
+#include "ArenaGrid.h"
+
+FHexFlowField::FHexFlowField()
+{
+}
+
+void FHexFlowField::Build(const AArenaGrid* grid, const TArray<int>& goals, float maxClimb)
+{
+	int numTiles = grid ? grid->FloorPieces.Num() : 0;
+	mNextTile.Init(INDEX_NONE, numTiles);
+	mDistance.Init(INDEX_NONE, numTiles);
+	mFrontier.Reset(numTiles);
+
+	for (int goal : goals)
+	{
+		if (mDistance.IsValidIndex(goal) && mDistance[goal] == INDEX_NONE)
+		{
+			mDistance[goal] = 0;
+			mNextTile[goal] = goal;
+			mFrontier.Add(goal);
+		}
+	}
+
+	// Search outwards from the goals, every tile reached points back at the tile it was reached from
+	for (int head = 0; head < mFrontier.Num(); head++)
+	{
+		int current = mFrontier[head];
+		float currentHeight = grid->FloorHeights.IsValidIndex(current) ? grid->FloorHeights[current] : 0.0f;
+
+		grid->ForEachTileInRange(current, 1, [&](int neighbour)
+		{
+			if (mDistance[neighbour] != INDEX_NONE)
+				return;
+
+			// A unit on the neighbour would have to climb up to the current tile
+			float neighbourHeight = grid->FloorHeights.IsValidIndex(neighbour) ? grid->FloorHeights[neighbour] : 0.0f;
+			if (maxClimb > 0.0f && currentHeight - neighbourHeight > maxClimb)
+				return;
+
+			mDistance[neighbour] = mDistance[current] + 1;
+			mNextTile[neighbour] = current;
+			mFrontier.Add(neighbour);
+		});
+	}
+}
+
+void FHexFlowField::Reset()
+{
+	mNextTile.Reset();
+	mDistance.Reset();
+}
@@ -0,0 +1,116 @@
+/**
+ * @file HexInfluenceMap.cpp
+ * @brief Defines the per-tile influence map used by the AI to reason about the arena without iterating actors
+ * @dependencies ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ *	https://www.redblobgames.com/grids/hexagons/
+ **/
+
+#include "HexInfluenceMap.h"
+#include "ArenaGrid.h"
+
+FHexInfluenceMap::FHexInfluenceMap()
+	: mNumTiles(0)
+{
+}
+
+void FHexInfluenceMap::Init(const AArenaGrid* grid, int spreadRings)
+{
+	mNumTiles = grid ? grid->FloorPieces.Num() : 0;
+	spreadRings = FMath::Max(spreadRings, 0);
+
+	// Pad the layers so the decay pass can always work on 4 floats at a time
+	int padded = Align(mNumTiles, 4);
+	for (int layer = 0; layer < NUM_INFLUENCE_LAYERS; layer++)
+	{
+		mPresence[layer].Init(0.0f, padded);
+		mValue[layer].Init(0.0f, padded);
+	}
+
+	mSpreadStart.Reset(mNumTiles + 1);
+	mSpreadTiles.Reset();
+	mSpreadWeights.Reset();
+
+	// Precompute the tiles and falloff weights every tile spreads its influence to
+	TArray<int> inRange;
+	for (int tile = 0; tile < mNumTiles; tile++)
+	{
+		mSpreadStart.Add(mSpreadTiles.Num());
+
+		grid->GetTilesInRange(tile, spreadRings, inRange);
+		for (int other : inRange)
+		{
+			// Fall off linearly, the last ring still gets a small amount
+			float weight = 1.0f - (float)grid->GetTileDistance(tile, other) / (spreadRings + 1);
+
+			mSpreadTiles.Add(other);
+			mSpreadWeights.Add(weight);
+		}
+	}
+	mSpreadStart.Add(mSpreadTiles.Num());
+}
+
+void FHexInfluenceMap::Reset()
+{
+	for (int layer = 0; layer < NUM_INFLUENCE_LAYERS; layer++)
+		ResetLayer((EInfluenceLayer)layer);
+}
+
+void FHexInfluenceMap::ResetLayer(EInfluenceLayer layer)
+{
+	FMemory::Memzero(mPresence[layer].GetData(), mPresence[layer].Num() * sizeof(float));
+	FMemory::Memzero(mValue[layer].GetData(), mValue[layer].Num() * sizeof(float));
+}
+
+void FHexInfluenceMap::AddSource(EInfluenceLayer layer, int tile, float strength)
+{
+	if (tile < 0 || tile >= mNumTiles)
+		return;
+
+	float* presence = mPresence[layer].GetData();
+	float* value = mValue[layer].GetData();
+
+	// Spread the source over its precomputed neighborhood
+	for (int i = mSpreadStart[tile]; i < mSpreadStart[tile + 1]; i++)
+	{
+		int other = mSpreadTiles[i];
+		presence[other] += strength * mSpreadWeights[i];
+
+		// New influence shows up straight away, removed influence fades out through Decay
+		value[other] = FMath::Max(value[other], presence[other]);
+	}
+}
+
+void FHexInfluenceMap::MoveSource(EInfluenceLayer layer, int fromTile, int toTile, float strength)
+{
+	if (fromTile == toTile)
+		return;
+
+	AddSource(layer, fromTile, -strength);
+	AddSource(layer, toTile, strength);
+}
+
+void FHexInfluenceMap::Decay(float deltaTime, float halfLife)
+{
+	if (mNumTiles == 0)
+		return;
+
+	float factor = halfLife > 0.0f ? FMath::Pow(0.5f, deltaTime / halfLife) : 0.0f;
+	VectorRegister decay = VectorSetFloat1(factor);
+
+	// value = max(value * factor, presence), 4 tiles at a time
+	for (int layer = 0; layer < NUM_INFLUENCE_LAYERS; layer++)
+	{
+		float* value = mValue[layer].GetData();
+		const float* presence = mPresence[layer].GetData();
+		int count = mValue[layer].Num();
+
+		for (int i = 0; i < count; i += 4)
+		{
+			VectorRegister decayed = VectorMultiply(VectorLoad(value + i), decay);
+			VectorStore(VectorMax(decayed, VectorLoad(presence + i)), value + i);
+		}
+	}
+}
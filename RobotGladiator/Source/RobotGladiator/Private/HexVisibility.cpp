@@ -0,0 +1,78 @@
+/**
+ * @file HexVisibility.cpp
+ * @brief Defines a table of which arena tiles can see each other, built from the floor heights a slice at a time
+ * @dependencies ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ *	https://www.redblobgames.com/grids/hexagons/
+ **/
+
+#include "HexVisibility.h"
+#include "ArenaGrid.h"
+
+FHexVisibility::FHexVisibility()
+{
+	mNumTiles = 0;
+	mRow = 0;
+	mColumn = 0;
+}
+
+void FHexVisibility::Update(const AArenaGrid* grid, float eyeHeight, int maxPairs)
+{
+	if (!grid)
+		return;
+
+	int numTiles = grid->FloorPieces.Num();
+
+	// Any tile moving can open or block any line, so a new floor means a new table
+	if (numTiles != mNumTiles || grid->FloorHeights != mHeights)
+	{
+		mNumTiles = numTiles;
+		mHeights = grid->FloorHeights;
+		mBits.Init(false, numTiles * numTiles);
+		mRow = 0;
+		mColumn = 0;
+	}
+
+	while (mRow < mNumTiles && maxPairs > 0)
+	{
+		float fromHeight = grid->GetTileSurfaceHeight(mRow) + eyeHeight;
+		int rowStart = mRow * mNumTiles;
+
+		for (; mColumn < mNumTiles && maxPairs > 0; mColumn++, maxPairs--)
+		{
+			mBits[rowStart + mColumn] = grid->HasTileLineOfSight(mRow, fromHeight, mColumn, grid->GetTileSurfaceHeight(mColumn) + eyeHeight);
+		}
+
+		if (mColumn >= mNumTiles)
+		{
+			mRow++;
+			mColumn = 0;
+		}
+	}
+}
+
+void FHexVisibility::Reset()
+{
+	mBits.Empty();
+	mNumTiles = 0;
+	mRow = 0;
+	mColumn = 0;
+	mHeights.Reset();
+}
+
+bool FHexVisibility::IsVisible(const AArenaGrid* grid, int fromTile, int toTile, float eyeHeight) const
+{
+	if (fromTile < 0 || toTile < 0 || fromTile >= mNumTiles || toTile >= mNumTiles)
+		return true;
+
+	// Lines of sight go both ways, so either finished row will do
+	if (fromTile < mRow)
+		return mBits[fromTile * mNumTiles + toTile];
+
+	if (toTile < mRow)
+		return mBits[toTile * mNumTiles + fromTile];
+
+	return grid->HasTileLineOfSight(fromTile, grid->GetTileSurfaceHeight(fromTile) + eyeHeight, toTile, grid->GetTileSurfaceHeight(toTile) + eyeHeight);
+}
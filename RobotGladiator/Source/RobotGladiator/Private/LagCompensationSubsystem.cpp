@@ -0,0 +1,254 @@
+/**
+ * @file LagCompensationSubsystem.cpp
+ * @brief Defines a world subsystem that keeps a short history of where every unit was so the server can check
+ *		players' hits against what they saw
+ * @dependencies WorldSubsystem.h, Tickable.h, PositionHistory.h, BaseUnit.h, ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "LagCompensationSubsystem.h"
+#include "BaseUnit.h"
+#include "ArenaGrid.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+
+ULagCompensationSubsystem::ULagCompensationSubsystem()
+{
+	// Overridden by DefaultGame.ini
+	HistorySeconds = 1.0f;
+	SampleRate = 30.0f;
+	PositionQuantum = 1.0f;
+	InterpolationDelay = 0.1f;
+	MaxRewindSeconds = 0.5f;
+
+	mAccumulator = 0.0f;
+}
+
+ULagCompensationSubsystem* ULagCompensationSubsystem::Get(const UObject* worldContextObject)
+{
+	UWorld* world = worldContextObject ? worldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<ULagCompensationSubsystem>() : nullptr;
+}
+
+void ULagCompensationSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	mHistory.Init(FMath::CeilToInt(HistorySeconds * SampleRate) + 1, PositionQuantum, FVector::ZeroVector);
+}
+
+void ULagCompensationSubsystem::Deinitialize()
+{
+	mUnits.Empty();
+	mHistory.Init(2, PositionQuantum, FVector::ZeroVector);
+
+	Super::Deinitialize();
+}
+
+void ULagCompensationSubsystem::Tick(float DeltaTime)
+{
+	float sampleInterval = 1.0f / FMath::Max(SampleRate, 1.0f);
+
+	// Samples are evenly spaced so the history always covers the same length of time
+	mAccumulator += DeltaTime;
+	if (mAccumulator < sampleInterval)
+		return;
+
+	mAccumulator = FMath::Fmod(mAccumulator, sampleInterval);
+	mHistory.BeginSample(GetWorld()->GetTimeSeconds());
+
+	for (int i = 0; i < mUnits.Num(); i++)
+	{
+		ABaseUnit* unit = mUnits[i];
+		FVector location = unit->GetActorLocation();
+		FitHistory(location);
+		mHistory.WriteSample(i, location, unit->GetActorRotation().Yaw);
+	}
+}
+
+bool ULagCompensationSubsystem::IsTickable() const
+{
+	// Only the server checks hits
+	UWorld* world = GetWorld();
+	return !IsTemplate() && mUnits.Num() > 0 && world && world->GetNetMode() != NM_Client;
+}
+
+UWorld* ULagCompensationSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId ULagCompensationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+void ULagCompensationSubsystem::RegisterUnit(ABaseUnit* unit)
+{
+	if (!unit || (mUnits.IsValidIndex(unit->mHistoryHandle) && mUnits[unit->mHistoryHandle] == unit))
+		return;
+
+	// An empty history goes back to full precision, centred on the arena where the fighting happens
+	if (mHistory.GetNumUnits() == 0)
+	{
+		AArenaGrid* arena = AArenaGrid::FindArena(this);
+		FVector origin = FVector::ZeroVector;
+		if (arena)
+			origin = arena->FloorPieces.Num() > 0 ? arena->GetTileCenter(0) : arena->GetActorLocation();
+
+		mHistory.Rebase(origin, PositionQuantum);
+	}
+
+	FitHistory(unit->GetActorLocation());
+	unit->mHistoryHandle = mHistory.AddUnit(unit->GetActorLocation(), unit->GetActorRotation().Yaw);
+	mUnits.Add(unit);
+}
+
+void ULagCompensationSubsystem::UnregisterUnit(ABaseUnit* unit)
+{
+	if (!unit || !mUnits.IsValidIndex(unit->mHistoryHandle) || mUnits[unit->mHistoryHandle] != unit)
+		return;
+
+	int handle = unit->mHistoryHandle;
+	unit->mHistoryHandle = INDEX_NONE;
+
+	// The history moves the last unit into the freed handle, so the unit list does the same
+	mHistory.RemoveUnit(handle);
+	mUnits.RemoveAtSwap(handle, 1, false);
+
+	if (mUnits.IsValidIndex(handle))
+		mUnits[handle]->mHistoryHandle = handle;
+}
+
+void ULagCompensationSubsystem::FitHistory(const FVector& location)
+{
+	if (mHistory.IsInRange(location))
+		return;
+
+	// Leave some room past the location so a unit moving away doesn't coarsen the history every sample
+	FVector offset = (location - mHistory.GetOrigin()).GetAbs();
+	float quantum = FMath::Max(mHistory.GetQuantum(), offset.GetMax() * 1.5f / 32767.0f);
+	mHistory.Rebase(mHistory.GetOrigin(), quantum);
+}
+
+float ULagCompensationSubsystem::GetShooterTime(const AActor* shooter) const
+{
+	float now = GetWorld()->GetTimeSeconds();
+
+	// Anything controlled on the server sees the world as it is
+	const APawn* pawn = Cast<APawn>(shooter);
+	if (!pawn || pawn->IsLocallyControlled() || !pawn->GetPlayerState())
+		return now;
+
+	// The client saw the target a round trip plus its interpolation delay ago
+	float rewind = pawn->GetPlayerState()->ExactPing * 0.001f + InterpolationDelay;
+	return now - FMath::Clamp(rewind, 0.0f, FMath::Min(MaxRewindSeconds, HistorySeconds));
+}
+
+bool ULagCompensationSubsystem::GetLocationAtTime(const ABaseUnit* unit, float time, FVector& outLocation) const
+{
+	int newer, older;
+	float alpha;
+	if (!unit || !mUnits.IsValidIndex(unit->mHistoryHandle) || mUnits[unit->mHistoryHandle] != unit || !FindSlots(time, newer, older, alpha))
+	{
+		outLocation = unit ? unit->GetActorLocation() : FVector::ZeroVector;
+		return false;
+	}
+
+	outLocation = GetLocationBetweenSlots(unit, newer, older, alpha);
+	return true;
+}
+
+FVector ULagCompensationSubsystem::GetLocationBetweenSlots(const ABaseUnit* unit, int newer, int older, float alpha) const
+{
+	if (!mUnits.IsValidIndex(unit->mHistoryHandle) || mUnits[unit->mHistoryHandle] != unit)
+		return unit->GetActorLocation();
+
+	FVector location;
+	float yaw;
+	mHistory.GetTransform(unit->mHistoryHandle, newer, older, alpha, location, yaw);
+	return location;
+}
+
+bool ULagCompensationSubsystem::ValidateHit(const AActor* shooter, const ABaseUnit* target, FVector hitLocation, float tolerance) const
+{
+	if (!IsValid(target))
+		return false;
+
+	FVector location;
+	GetLocationAtTime(target, GetShooterTime(shooter), location);
+
+	// Treat the target as its capsule where it was
+	UCapsuleComponent* capsule = target->GetCapsuleComponent();
+	float radius = capsule->GetScaledCapsuleRadius() + tolerance;
+	float halfHeight = capsule->GetScaledCapsuleHalfHeight() + tolerance;
+	FVector offset = hitLocation - location;
+
+	return offset.SizeSquared2D() <= radius * radius && FMath::Abs(offset.Z) <= halfHeight;
+}
+
+#if !UE_BUILD_SHIPPING
+/** @brief Measures the position history at a given size: memory used, cost of recording a sample of every unit,
+ *		and cost of a rewind (finding the slots and reading one unit). Usage: RobotGladiator.BenchmarkLagCompensation [units] [seconds] [rate]
+ */
+static void BenchmarkLagCompensation(const TArray<FString>& args, UWorld* world, FOutputDevice& ar)
+{
+	int numUnits = args.Num() > 0 ? FCString::Atoi(*args[0]) : 200;
+	float seconds = args.Num() > 1 ? FCString::Atof(*args[1]) : 1.0f;
+	float rate = args.Num() > 2 ? FCString::Atof(*args[2]) : 30.0f;
+	int numSamples = FMath::CeilToInt(seconds * rate) + 1;
+	const int numRewinds = 100000;
+
+	FRandomStream rand(1234);
+	FPositionHistory history(numSamples, 1.0f, FVector::ZeroVector);
+	TArray<FVector> locations;
+	for (int i = 0; i < numUnits; i++)
+	{
+		locations.Add(FVector(rand.FRandRange(-20000.0f, 20000.0f), rand.FRandRange(-20000.0f, 20000.0f), rand.FRandRange(0.0f, 3000.0f)));
+		history.AddUnit(locations[i], rand.FRandRange(-180.0f, 180.0f));
+	}
+
+	// Record several times around the ring so every slot has been written
+	int numRecords = numSamples * 10;
+	double start = FPlatformTime::Seconds();
+	for (int s = 0; s < numRecords; s++)
+	{
+		history.BeginSample(s / rate);
+		for (int i = 0; i < numUnits; i++)
+		{
+			history.WriteSample(i, locations[i] + FVector(s, -s, 0.0f), (float)s);
+		}
+	}
+	double recordSeconds = (FPlatformTime::Seconds() - start) / numRecords;
+
+	// Rewind random units to random times inside the history
+	float newest = history.GetNewestTime();
+	float oldest = history.GetOldestTime();
+	FVector checksum = FVector::ZeroVector;
+	start = FPlatformTime::Seconds();
+	for (int r = 0; r < numRewinds; r++)
+	{
+		int newer, older;
+		float alpha, yaw;
+		FVector location;
+		history.FindSlots(rand.FRandRange(oldest, newest), newer, older, alpha);
+		history.GetTransform(rand.RandHelper(numUnits), newer, older, alpha, location, yaw);
+		checksum += location;
+	}
+	double rewindSeconds = (FPlatformTime::Seconds() - start) / numRewinds;
+
+	ar.Logf(TEXT("Lag compensation: %d units x %d samples (%.2fs at %.0fHz)"), numUnits, numSamples, seconds, rate);
+	ar.Logf(TEXT("  Memory: %llu bytes (%.1f bytes per unit per sample)"), (uint64)history.GetAllocatedSize(), (float)history.GetAllocatedSize() / FMath::Max(numUnits * numSamples, 1));
+	ar.Logf(TEXT("  Record: %.3f us per sample of every unit"), recordSeconds * 1e6);
+	ar.Logf(TEXT("  Rewind: %.3f us per unit (checksum %s)"), rewindSeconds * 1e6, *checksum.ToString());
+}
+
+static FAutoConsoleCommand GBenchmarkLagCompensation(
+	TEXT("RobotGladiator.BenchmarkLagCompensation"),
+	TEXT("Measures the memory and CPU cost of the lag compensation position history. Args: [units=200] [seconds=1] [rate=30]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&BenchmarkLagCompensation));
+#endif
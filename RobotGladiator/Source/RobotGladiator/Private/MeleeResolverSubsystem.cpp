@@ -0,0 +1,209 @@
+/**
+ * @file MeleeResolverSubsystem.cpp
+ * @brief Defines a world subsystem that resolves every melee swing of a frame against the arena occupancy index
+ * @dependencies WorldSubsystem.h, Tickable.h, ArenaGrid.h, DamageQueueSubsystem.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "MeleeResolverSubsystem.h"
+#include "ArenaGrid.h"
+#include "BaseUnit.h"
+#include "DamageQueueSubsystem.h"
+#include "LagCompensationSubsystem.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+
+UMeleeResolverSubsystem::UMeleeResolverSubsystem()
+{
+	VerticalReach = 100.0f;
+
+	mpArena = nullptr;
+}
+
+UMeleeResolverSubsystem* UMeleeResolverSubsystem::Get(const UObject* worldContextObject)
+{
+	UWorld* world = worldContextObject ? worldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UMeleeResolverSubsystem>() : nullptr;
+}
+
+void UMeleeResolverSubsystem::Deinitialize()
+{
+	mSwings.Empty();
+	mCandidates.Empty();
+	mpArena = nullptr;
+
+	Super::Deinitialize();
+}
+
+void UMeleeResolverSubsystem::Tick(float DeltaTime)
+{
+	ResolveSwings();
+}
+
+bool UMeleeResolverSubsystem::IsTickable() const
+{
+	return !IsTemplate() && mSwings.Num() > 0;
+}
+
+UWorld* UMeleeResolverSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UMeleeResolverSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMeleeResolverSubsystem, STATGROUP_Tickables);
+}
+
+void UMeleeResolverSubsystem::QueueSwing(ABaseUnit* attacker, FVector origin, FVector facing, float angle, float range, float damage)
+{
+	if (!attacker || range <= 0.0f)
+		return;
+
+	FMeleeSwing swing;
+	swing.Attacker = attacker;
+	swing.Origin = origin;
+	swing.Facing = FVector2D(facing.X, facing.Y).GetSafeNormal();
+	swing.CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(angle, 0.0f, 360.0f) * 0.5f));
+	swing.Range = range;
+	swing.Damage = damage;
+	swing.RewindTime = -1.0f;
+
+	// A remote player swung at what their client showed them, so check against where the targets were then
+	if (attacker->mIsPlayerUnit)
+	{
+		ULagCompensationSubsystem* lagCompensation = ULagCompensationSubsystem::Get(this);
+		float shooterTime = lagCompensation ? lagCompensation->GetShooterTime(attacker) : -1.0f;
+		if (shooterTime >= 0.0f && shooterTime < GetWorld()->GetTimeSeconds())
+			swing.RewindTime = shooterTime;
+	}
+
+	mSwings.Add(swing);
+}
+
+void UMeleeResolverSubsystem::ResolveSwings()
+{
+	if (!IsValid(mpArena))
+		mpArena = AArenaGrid::FindArena(this);
+
+	// Swings queued while resolving (e.g. by hit reactions) wait for the next frame
+	TArray<FMeleeSwing> swings = MoveTemp(mSwings);
+	mSwings.Reset();
+
+	if (!mpArena)
+		return;
+
+	for (const FMeleeSwing& swing : swings)
+	{
+		if (!IsValid(swing.Attacker) || !swing.Attacker->mIsActive)
+			continue;
+
+		GatherCandidates(swing);
+		TestCandidates(swing);
+	}
+}
+
+void UMeleeResolverSubsystem::GatherCandidates(const FMeleeSwing& swing)
+{
+	mCandidates.Reset();
+	mCandidateX.Reset();
+	mCandidateY.Reset();
+	mCandidateZ.Reset();
+	mCandidateRadius.Reset();
+	mCandidateHalfHeight.Reset();
+
+	int tile = mpArena->GetTileAtLocation(swing.Origin);
+	int rings = mpArena->GetRingsForDistance(swing.Range);
+	bool attackerIsPlayer = swing.Attacker->mIsPlayerUnit;
+
+	// The slots are found once and shared by every candidate of the swing
+	ULagCompensationSubsystem* lagCompensation = nullptr;
+	int newer = 0, older = 0;
+	float alpha = 0.0f;
+	if (swing.RewindTime >= 0.0f)
+	{
+		lagCompensation = ULagCompensationSubsystem::Get(this);
+		if (lagCompensation && lagCompensation->FindSlots(swing.RewindTime, newer, older, alpha))
+			rings++;	// Units are indexed by the tile they're on now and may have moved since
+		else
+			lagCompensation = nullptr;
+	}
+
+	mpArena->ForEachTileInRange(tile, rings, [&](int found)
+	{
+		for (int handle : mpArena->Occupancy.GetTileUnits(found))
+		{
+			ABaseUnit* unit = mpArena->Occupancy.GetUnit(handle);
+			if (!unit || unit->mIsPlayerUnit == attackerIsPlayer)
+				continue;
+
+			FVector location = lagCompensation ? lagCompensation->GetLocationBetweenSlots(unit, newer, older, alpha) : unit->GetActorLocation();
+			UCapsuleComponent* capsule = unit->GetCapsuleComponent();
+
+			mCandidates.Add(unit);
+			mCandidateX.Add(location.X);
+			mCandidateY.Add(location.Y);
+			mCandidateZ.Add(location.Z);
+			mCandidateRadius.Add(capsule->GetScaledCapsuleRadius());
+			mCandidateHalfHeight.Add(capsule->GetScaledCapsuleHalfHeight());
+		}
+	});
+
+	// Pad with candidates far out of range so every group of 4 can be loaded whole
+	while (mCandidateX.Num() % 4 != 0)
+	{
+		mCandidateX.Add(1e15f);
+		mCandidateY.Add(1e15f);
+		mCandidateZ.Add(1e15f);
+		mCandidateRadius.Add(0.0f);
+		mCandidateHalfHeight.Add(0.0f);
+	}
+}
+
+void UMeleeResolverSubsystem::TestCandidates(const FMeleeSwing& swing)
+{
+	UDamageQueueSubsystem* damageQueue = UDamageQueueSubsystem::Get(this);
+
+	VectorRegister originX = VectorSetFloat1(swing.Origin.X);
+	VectorRegister originY = VectorSetFloat1(swing.Origin.Y);
+	VectorRegister originZ = VectorSetFloat1(swing.Origin.Z);
+	VectorRegister facingX = VectorSetFloat1(swing.Facing.X);
+	VectorRegister facingY = VectorSetFloat1(swing.Facing.Y);
+	VectorRegister range = VectorSetFloat1(swing.Range);
+	VectorRegister verticalReach = VectorSetFloat1(VerticalReach);
+
+	// Squared with its sign kept so arcs wider than 180 degrees still work
+	VectorRegister cosSq = VectorSetFloat1(swing.CosHalfAngle * FMath::Abs(swing.CosHalfAngle));
+
+	for (int i = 0; i < mCandidateX.Num(); i += 4)
+	{
+		VectorRegister dx = VectorSubtract(VectorLoad(&mCandidateX[i]), originX);
+		VectorRegister dy = VectorSubtract(VectorLoad(&mCandidateY[i]), originY);
+		VectorRegister dz = VectorAbs(VectorSubtract(VectorLoad(&mCandidateZ[i]), originZ));
+
+		VectorRegister distSq = VectorMultiplyAdd(dx, dx, VectorMultiply(dy, dy));
+		VectorRegister reach = VectorAdd(range, VectorLoad(&mCandidateRadius[i]));
+		VectorRegister inRange = VectorCompareGE(VectorMultiply(reach, reach), distSq);
+
+		// dot >= cos * length, compared as dot * |dot| >= cos * |cos| * length^2 to avoid the square root
+		VectorRegister dot = VectorMultiplyAdd(dx, facingX, VectorMultiply(dy, facingY));
+		VectorRegister inArc = VectorCompareGE(VectorMultiply(dot, VectorAbs(dot)), VectorMultiply(cosSq, distSq));
+
+		VectorRegister inHeight = VectorCompareGE(VectorAdd(VectorLoad(&mCandidateHalfHeight[i]), verticalReach), dz);
+
+		int hits = VectorMaskBits(VectorBitwiseAnd(VectorBitwiseAnd(inRange, inArc), inHeight));
+		for (int lane = 0; hits != 0; lane++, hits >>= 1)
+		{
+			if (!(hits & 1))
+				continue;
+
+			ABaseUnit* target = mCandidates[i + lane];
+			if (damageQueue)
+				damageQueue->QueueDamage(target, swing.Damage, swing.Attacker);
+
+			swing.Attacker->OnMeleeHit(target);
+		}
+	}
+}
@@ -0,0 +1,269 @@
+/**
+ * @file PlayerRegistrySubsystem.cpp
+ * @brief Defines a world subsystem that keeps a live, spatially hashed registry of player pawns
+ * @dependencies WorldSubsystem.h, Tickable.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "PlayerRegistrySubsystem.h"
+#include "Engine/World.h"
+
+UPlayerRegistrySubsystem::UPlayerRegistrySubsystem()
+{
+	// Roughly the size of a few arena tiles
+	mCellSize = 2000.0f;
+}
+
+UPlayerRegistrySubsystem* UPlayerRegistrySubsystem::Get(const UObject* worldContextObject)
+{
+	UWorld* world = worldContextObject ? worldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UPlayerRegistrySubsystem>() : nullptr;
+}
+
+void UPlayerRegistrySubsystem::Deinitialize()
+{
+	mPlayers.Empty();
+	mCells.Empty();
+	mGrid.Empty();
+
+	Super::Deinitialize();
+}
+
+void UPlayerRegistrySubsystem::Tick(float DeltaTime)
+{
+	// Move players whose location has crossed into another cell since last frame
+	for (int i = 0; i < mPlayers.Num(); i++)
+	{
+		if (!IsValid(mPlayers[i]))
+			continue;
+
+		FIntPoint cell = GetCell(mPlayers[i]->GetActorLocation());
+		if (cell != mCells[i])
+		{
+			RemoveFromCell(i);
+			mCells[i] = cell;
+			AddToCell(i);
+		}
+	}
+}
+
+bool UPlayerRegistrySubsystem::IsTickable() const
+{
+	return !IsTemplate() && mPlayers.Num() > 0;
+}
+
+UWorld* UPlayerRegistrySubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UPlayerRegistrySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPlayerRegistrySubsystem, STATGROUP_Tickables);
+}
+
+void UPlayerRegistrySubsystem::RegisterPlayer(AActor* player)
+{
+	if (!player || mPlayers.Contains(player))
+		return;
+
+	int index = mPlayers.Add(player);
+	mCells.Add(GetCell(player->GetActorLocation()));
+	AddToCell(index);
+}
+
+void UPlayerRegistrySubsystem::UnregisterPlayer(AActor* player)
+{
+	int index = mPlayers.Find(player);
+	if (index == INDEX_NONE)
+		return;
+
+	// Swap the last player into the removed player's index so the arrays stay packed
+	int last = mPlayers.Num() - 1;
+	RemoveFromCell(index);
+	if (index != last)
+	{
+		RemoveFromCell(last);
+		mPlayers[index] = mPlayers[last];
+		mCells[index] = mCells[last];
+		AddToCell(index);
+	}
+
+	mPlayers.Pop(false);
+	mCells.Pop(false);
+}
+
+AActor* UPlayerRegistrySubsystem::FindClosestPlayer(FVector location, TSubclassOf<AActor> classFilter, const AActor* ignore) const
+{
+	AActor* closestPlayer = nullptr;
+	float closestDistSq = MAX_flt;
+
+	FIntPoint center = GetCell(location);
+	int maxRing = GetMaxRing(center);
+
+	// Search outwards one ring of cells at a time
+	for (int ring = 0; ring <= maxRing; ring++)
+	{
+		for (int x = center.X - ring; x <= center.X + ring; x++)
+		{
+			for (int y = center.Y - ring; y <= center.Y + ring; y++)
+			{
+				// Only the border of the square is new in this ring
+				if (FMath::Max(FMath::Abs(x - center.X), FMath::Abs(y - center.Y)) != ring)
+					continue;
+
+				const TArray<int>* cell = mGrid.Find(FIntPoint(x, y));
+				if (!cell)
+					continue;
+
+				for (int index : *cell)
+				{
+					if (!IsCandidate(index, classFilter, ignore))
+						continue;
+
+					float distSq = FVector::DistSquared(location, mPlayers[index]->GetActorLocation());
+					if (distSq < closestDistSq)
+					{
+						closestPlayer = mPlayers[index];
+						closestDistSq = distSq;
+					}
+				}
+			}
+		}
+
+		// Anything in the next ring is at least this far away
+		float ringDist = ring * mCellSize;
+		if (closestPlayer && closestDistSq <= ringDist * ringDist)
+			break;
+	}
+
+	return closestPlayer;
+}
+
+void UPlayerRegistrySubsystem::FindNearestPlayers(FVector location, int count, TArray<AActor*>& outPlayers) const
+{
+	outPlayers.Reset();
+	if (count <= 0)
+		return;
+
+	// Found players sorted by distance, never more than count of them
+	TArray<TPair<float, AActor*>, TInlineAllocator<8>> nearest;
+
+	FIntPoint center = GetCell(location);
+	int maxRing = GetMaxRing(center);
+
+	// Search outwards one ring of cells at a time
+	for (int ring = 0; ring <= maxRing; ring++)
+	{
+		for (int x = center.X - ring; x <= center.X + ring; x++)
+		{
+			for (int y = center.Y - ring; y <= center.Y + ring; y++)
+			{
+				// Only the border of the square is new in this ring
+				if (FMath::Max(FMath::Abs(x - center.X), FMath::Abs(y - center.Y)) != ring)
+					continue;
+
+				const TArray<int>* cell = mGrid.Find(FIntPoint(x, y));
+				if (!cell)
+					continue;
+
+				for (int index : *cell)
+				{
+					if (!IsCandidate(index, nullptr, nullptr))
+						continue;
+
+					float distSq = FVector::DistSquared(location, mPlayers[index]->GetActorLocation());
+					if (nearest.Num() == count && distSq >= nearest.Last().Key)
+						continue;
+
+					// Insert in order, dropping the farthest player if the list is full
+					int insertAt = 0;
+					while (insertAt < nearest.Num() && nearest[insertAt].Key <= distSq)
+						insertAt++;
+
+					nearest.Insert(TPair<float, AActor*>(distSq, mPlayers[index]), insertAt);
+					if (nearest.Num() > count)
+						nearest.Pop(false);
+				}
+			}
+		}
+
+		// Anything in the next ring is at least this far away
+		float ringDist = ring * mCellSize;
+		if (nearest.Num() == count && nearest.Last().Key <= ringDist * ringDist)
+			break;
+	}
+
+	for (const TPair<float, AActor*>& found : nearest)
+	{
+		outPlayers.Add(found.Value);
+	}
+}
+
+void UPlayerRegistrySubsystem::FindPlayersInRadius(FVector location, float radius, TArray<AActor*>& outPlayers) const
+{
+	outPlayers.Reset();
+
+	FIntPoint minCell = GetCell(location - FVector(radius, radius, 0.0f));
+	FIntPoint maxCell = GetCell(location + FVector(radius, radius, 0.0f));
+	float radiusSq = radius * radius;
+
+	// Only check the cells the radius overlaps
+	for (int x = minCell.X; x <= maxCell.X; x++)
+	{
+		for (int y = minCell.Y; y <= maxCell.Y; y++)
+		{
+			const TArray<int>* cell = mGrid.Find(FIntPoint(x, y));
+			if (!cell)
+				continue;
+
+			for (int index : *cell)
+			{
+				if (IsCandidate(index, nullptr, nullptr) && FVector::DistSquared(location, mPlayers[index]->GetActorLocation()) <= radiusSq)
+					outPlayers.Add(mPlayers[index]);
+			}
+		}
+	}
+}
+
+FIntPoint UPlayerRegistrySubsystem::GetCell(const FVector& location) const
+{
+	return FIntPoint(FMath::FloorToInt(location.X / mCellSize), FMath::FloorToInt(location.Y / mCellSize));
+}
+
+void UPlayerRegistrySubsystem::AddToCell(int index)
+{
+	mGrid.FindOrAdd(mCells[index]).Add(index);
+}
+
+void UPlayerRegistrySubsystem::RemoveFromCell(int index)
+{
+	TArray<int>* cell = mGrid.Find(mCells[index]);
+	if (!cell)
+		return;
+
+	cell->RemoveSingleSwap(index, false);
+
+	// Don't keep empty cells around, the ring search walks the occupied ones
+	if (cell->Num() == 0)
+		mGrid.Remove(mCells[index]);
+}
+
+bool UPlayerRegistrySubsystem::IsCandidate(int index, TSubclassOf<AActor> classFilter, const AActor* ignore) const
+{
+	AActor* player = mPlayers[index];
+	return IsValid(player) && player != ignore && (!classFilter || player->IsA(classFilter));
+}
+
+int UPlayerRegistrySubsystem::GetMaxRing(const FIntPoint& center) const
+{
+	int maxRing = 0;
+	for (const TPair<FIntPoint, TArray<int>>& cell : mGrid)
+	{
+		maxRing = FMath::Max(maxRing, FMath::Max(FMath::Abs(cell.Key.X - center.X), FMath::Abs(cell.Key.Y - center.Y)));
+	}
+
+	return maxRing;
+}
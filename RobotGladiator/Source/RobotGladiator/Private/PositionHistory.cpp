@@ -0,0 +1,176 @@
+/**
+ * @file PositionHistory.cpp
+ * @brief Defines a fixed size ring buffer of quantized unit positions used to rewind hits on the server
+ * @dependencies None
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "PositionHistory.h"
+
+FPositionHistory::FPositionHistory(int numSamples, float quantum, FVector origin)
+{
+	Init(numSamples, quantum, origin);
+}
+
+void FPositionHistory::Init(int numSamples, float quantum, FVector origin)
+{
+	mNumSamples = FMath::Max(numSamples, 2);
+	mQuantum = FMath::Max(quantum, KINDA_SMALL_NUMBER);
+	mOrigin = origin;
+	mNumUnits = 0;
+	mHead = 0;
+	mNumRecorded = 0;
+
+	mX.Reset();
+	mY.Reset();
+	mZ.Reset();
+	mYaw.Reset();
+	mTimes.Init(0.0f, mNumSamples);
+}
+
+void FPositionHistory::Rebase(FVector origin, float quantum)
+{
+	FVector oldOrigin = mOrigin;
+	float oldQuantum = mQuantum;
+	mOrigin = origin;
+	mQuantum = FMath::Max(quantum, KINDA_SMALL_NUMBER);
+
+	for (int i = 0; i < mX.Num(); i++)
+	{
+		mX[i] = Quantize(oldOrigin.X + mX[i] * oldQuantum, mOrigin.X);
+		mY[i] = Quantize(oldOrigin.Y + mY[i] * oldQuantum, mOrigin.Y);
+		mZ[i] = Quantize(oldOrigin.Z + mZ[i] * oldQuantum, mOrigin.Z);
+	}
+}
+
+bool FPositionHistory::IsInRange(const FVector& location) const
+{
+	float limit = 32767.0f * mQuantum;
+	FVector offset = (location - mOrigin).GetAbs();
+	return offset.X <= limit && offset.Y <= limit && offset.Z <= limit;
+}
+
+int FPositionHistory::AddUnit(const FVector& location, float yaw)
+{
+	int handle = mNumUnits++;
+
+	mX.AddUninitialized(mNumSamples);
+	mY.AddUninitialized(mNumSamples);
+	mZ.AddUninitialized(mNumSamples);
+	mYaw.AddUninitialized(mNumSamples);
+
+	// Rewinding to before the unit existed finds it where it started
+	for (int slot = 0; slot < mNumSamples; slot++)
+	{
+		int index = handle * mNumSamples + slot;
+		mX[index] = Quantize(location.X, mOrigin.X);
+		mY[index] = Quantize(location.Y, mOrigin.Y);
+		mZ[index] = Quantize(location.Z, mOrigin.Z);
+		mYaw[index] = FRotator::CompressAxisToShort(yaw);
+	}
+
+	return handle;
+}
+
+void FPositionHistory::RemoveUnit(int handle)
+{
+	if (handle < 0 || handle >= mNumUnits)
+		return;
+
+	int last = mNumUnits - 1;
+	if (handle != last)
+	{
+		// Blocks are the same size, so the last unit's whole history moves with four copies
+		int to = handle * mNumSamples;
+		int from = last * mNumSamples;
+		FMemory::Memcpy(&mX[to], &mX[from], mNumSamples * sizeof(int16));
+		FMemory::Memcpy(&mY[to], &mY[from], mNumSamples * sizeof(int16));
+		FMemory::Memcpy(&mZ[to], &mZ[from], mNumSamples * sizeof(int16));
+		FMemory::Memcpy(&mYaw[to], &mYaw[from], mNumSamples * sizeof(uint16));
+	}
+
+	mX.SetNum(last * mNumSamples, false);
+	mY.SetNum(last * mNumSamples, false);
+	mZ.SetNum(last * mNumSamples, false);
+	mYaw.SetNum(last * mNumSamples, false);
+	mNumUnits = last;
+}
+
+void FPositionHistory::BeginSample(float time)
+{
+	mHead = (mHead + 1) % mNumSamples;
+	mTimes[mHead] = time;
+	mNumRecorded = FMath::Min(mNumRecorded + 1, mNumSamples);
+}
+
+void FPositionHistory::WriteSample(int handle, const FVector& location, float yaw)
+{
+	int index = handle * mNumSamples + mHead;
+	mX[index] = Quantize(location.X, mOrigin.X);
+	mY[index] = Quantize(location.Y, mOrigin.Y);
+	mZ[index] = Quantize(location.Z, mOrigin.Z);
+	mYaw[index] = FRotator::CompressAxisToShort(yaw);
+}
+
+bool FPositionHistory::FindSlots(float time, int& outNewer, int& outOlder, float& outAlpha) const
+{
+	if (mNumRecorded == 0)
+		return false;
+
+	// Times only go down walking back from the head, so binary search over how many samples back to look
+	int low = 0;
+	int high = mNumRecorded - 1;
+	if (time >= mTimes[mHead])
+		high = 0;
+
+	while (low < high)
+	{
+		int mid = (low + high) / 2;
+		if (mTimes[(mHead - mid + mNumSamples) % mNumSamples] <= time)
+			high = mid;
+		else
+			low = mid + 1;
+	}
+
+	// low is the newest sample at or before the time, or the oldest sample if the time is older than all of them
+	outOlder = (mHead - low + mNumSamples) % mNumSamples;
+	outNewer = low > 0 ? (outOlder + 1) % mNumSamples : outOlder;
+
+	float span = mTimes[outNewer] - mTimes[outOlder];
+	outAlpha = span > 0.0f ? FMath::Clamp((mTimes[outNewer] - time) / span, 0.0f, 1.0f) : 0.0f;
+	return true;
+}
+
+void FPositionHistory::GetTransform(int handle, int newer, int older, float alpha, FVector& outLocation, float& outYaw) const
+{
+	int a = handle * mNumSamples + newer;
+	int b = handle * mNumSamples + older;
+
+	outLocation.X = Dequantize(mX[a], mOrigin.X) + (mX[b] - mX[a]) * mQuantum * alpha;
+	outLocation.Y = Dequantize(mY[a], mOrigin.Y) + (mY[b] - mY[a]) * mQuantum * alpha;
+	outLocation.Z = Dequantize(mZ[a], mOrigin.Z) + (mZ[b] - mZ[a]) * mQuantum * alpha;
+
+	// The difference wraps in 16 bits so blending always takes the short way around
+	int16 yawDelta = (int16)(uint16)(mYaw[b] - mYaw[a]);
+	outYaw = FRotator::DecompressAxisFromShort(mYaw[a]) + yawDelta * (360.0f / 65536.0f) * alpha;
+}
+
+float FPositionHistory::GetOldestTime() const
+{
+	if (mNumRecorded == 0)
+		return 0.0f;
+
+	return mTimes[(mHead - (mNumRecorded - 1) + mNumSamples) % mNumSamples];
+}
+
+SIZE_T FPositionHistory::GetAllocatedSize() const
+{
+	return mX.GetAllocatedSize() + mY.GetAllocatedSize() + mZ.GetAllocatedSize() + mYaw.GetAllocatedSize() + mTimes.GetAllocatedSize();
+}
+
+int16 FPositionHistory::Quantize(float value, float origin) const
+{
+	return (int16)FMath::Clamp(FMath::RoundToInt((value - origin) / mQuantum), -32767, 32767);
+}
@@ -0,0 +1,256 @@
+/**
+ * @file ProjectileSubsystem.cpp
+ * @brief Defines a world subsystem that simulates gladiator missiles as plain data instead of one actor per shot
+ * @dependencies WorldSubsystem.h, Tickable.h, ArenaGrid.h, DamageQueueSubsystem.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "ProjectileSubsystem.h"
+#include "ArenaGrid.h"
+#include "BaseUnit.h"
+#include "DamageQueueSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+
+UProjectileSubsystem::UProjectileSubsystem()
+{
+	// Overridden by DefaultGame.ini
+	ProjectileLifetime = 5.0f;
+	ProjectileRadius = 30.0f;
+	ProjectileMesh = FSoftObjectPath(TEXT("/Engine/BasicShapes/Sphere.Sphere"));
+	ProjectileMeshScale = 0.3f;
+
+	ParallelThreshold = 256;
+
+	mpArena = nullptr;
+	mpVisualProxy = nullptr;
+	mpInstances = nullptr;
+}
+
+UProjectileSubsystem* UProjectileSubsystem::Get(const UObject* worldContextObject)
+{
+	UWorld* world = worldContextObject ? worldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UProjectileSubsystem>() : nullptr;
+}
+
+void UProjectileSubsystem::Deinitialize()
+{
+	ClearProjectiles();
+
+	mpArena = nullptr;
+	mpVisualProxy = nullptr;
+	mpInstances = nullptr;
+
+	Super::Deinitialize();
+}
+
+void UProjectileSubsystem::Tick(float DeltaTime)
+{
+	if (!IsValid(mpArena))
+		mpArena = AArenaGrid::FindArena(this);
+
+	IntegrateProjectiles(DeltaTime);
+	CollideWithUnits();
+	RemoveDeadProjectiles();
+	UpdateVisuals();
+}
+
+bool UProjectileSubsystem::IsTickable() const
+{
+	// Keep ticking for a frame after the last projectile is gone so its instance is removed
+	return !IsTemplate() && (mPositions.Num() > 0 || (mpInstances && mpInstances->GetInstanceCount() > 0));
+}
+
+UWorld* UProjectileSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileSubsystem, STATGROUP_Tickables);
+}
+
+void UProjectileSubsystem::FireProjectile(FVector origin, FVector velocity, float damage, ABaseUnit* instigator, bool dealsDamage)
+{
+	uint8 flags = dealsDamage ? PROJECTILE_DEALS_DAMAGE : PROJECTILE_NONE;
+	if (instigator && instigator->mIsPlayerUnit)
+		flags |= PROJECTILE_FROM_PLAYER;
+
+	mPositions.Add(origin);
+	mVelocities.Add(velocity);
+	mDamage.Add(damage);
+	mTimeLeft.Add(ProjectileLifetime);
+	mTiles.Add(INDEX_NONE);
+	mFlags.Add(flags);
+	mInstigators.Add(instigator);
+}
+
+void UProjectileSubsystem::ClearProjectiles()
+{
+	mPositions.Reset();
+	mVelocities.Reset();
+	mDamage.Reset();
+	mTimeLeft.Reset();
+	mTiles.Reset();
+	mFlags.Reset();
+	mInstigators.Reset();
+}
+
+void UProjectileSubsystem::IntegrateProjectiles(float deltaTime)
+{
+	const AArenaGrid* arena = mpArena;
+
+	// Only reads the arena, so it's safe to split across worker threads
+	ParallelFor(mPositions.Num(), [this, arena, deltaTime](int32 i)
+	{
+		mPositions[i] += mVelocities[i] * deltaTime;
+		mTimeLeft[i] -= deltaTime;
+
+		if (mTimeLeft[i] <= 0.0f)
+		{
+			mFlags[i] |= PROJECTILE_DEAD;
+			return;
+		}
+
+		// Projectiles off the grid keep flying until they time out
+		mTiles[i] = arena ? arena->GetTileAtLocation(mPositions[i]) : INDEX_NONE;
+		if (mTiles[i] != INDEX_NONE && mPositions[i].Z - ProjectileRadius <= arena->GetTileSurfaceHeight(mTiles[i]))
+			mFlags[i] |= PROJECTILE_DEAD;
+	}, mPositions.Num() < ParallelThreshold);
+}
+
+void UProjectileSubsystem::CollideWithUnits()
+{
+	if (!mpArena)
+		return;
+
+	UDamageQueueSubsystem* damageQueue = UDamageQueueSubsystem::Get(this);
+
+	for (int i = 0; i < mPositions.Num(); i++)
+	{
+		if ((mFlags[i] & PROJECTILE_DEAD) || mTiles[i] == INDEX_NONE)
+			continue;
+
+		bool fromPlayer = (mFlags[i] & PROJECTILE_FROM_PLAYER) != 0;
+		ABaseUnit* hitUnit = nullptr;
+
+		// Units near the edge of the next tile can still be touched, so check the neighbouring tiles too
+		mpArena->ForEachTileInRange(mTiles[i], 1, [&](int tile)
+		{
+			if (hitUnit)
+				return;
+
+			for (int handle : mpArena->Occupancy.GetTileUnits(tile))
+			{
+				ABaseUnit* unit = mpArena->Occupancy.GetUnit(handle);
+				if (!unit || unit->mIsPlayerUnit == fromPlayer || unit == mInstigators[i])
+					continue;
+
+				// Treat the unit as its capsule
+				UCapsuleComponent* capsule = unit->GetCapsuleComponent();
+				float radius = capsule->GetScaledCapsuleRadius() + ProjectileRadius;
+				float halfHeight = capsule->GetScaledCapsuleHalfHeight() + ProjectileRadius;
+				FVector offset = mPositions[i] - unit->GetActorLocation();
+
+				if (offset.SizeSquared2D() <= radius * radius && FMath::Abs(offset.Z) <= halfHeight)
+				{
+					hitUnit = unit;
+					return;
+				}
+			}
+		});
+
+		if (!hitUnit)
+			continue;
+
+		mFlags[i] |= PROJECTILE_DEAD;
+
+		if ((mFlags[i] & PROJECTILE_DEALS_DAMAGE) && damageQueue)
+			damageQueue->QueueDamage(hitUnit, mDamage[i], mInstigators[i]);
+	}
+}
+
+void UProjectileSubsystem::RemoveDeadProjectiles()
+{
+	for (int i = mPositions.Num() - 1; i >= 0; i--)
+	{
+		if (!(mFlags[i] & PROJECTILE_DEAD))
+			continue;
+
+		mPositions.RemoveAtSwap(i, 1, false);
+		mVelocities.RemoveAtSwap(i, 1, false);
+		mDamage.RemoveAtSwap(i, 1, false);
+		mTimeLeft.RemoveAtSwap(i, 1, false);
+		mTiles.RemoveAtSwap(i, 1, false);
+		mFlags.RemoveAtSwap(i, 1, false);
+		mInstigators.RemoveAtSwap(i, 1, false);
+	}
+}
+
+void UProjectileSubsystem::UpdateVisuals()
+{
+	if (!mpInstances)
+	{
+		if (mPositions.Num() == 0)
+			return;
+
+		CreateVisualProxy();
+		if (!mpInstances)
+			return;
+	}
+
+	// Instances are interchangeable, so only the count has to match and every instance is just moved
+	int numInstances = mpInstances->GetInstanceCount();
+	FVector scale(ProjectileMeshScale);
+
+	for (int i = numInstances; i < mPositions.Num(); i++)
+	{
+		mpInstances->AddInstanceWorldSpace(FTransform(FRotator::ZeroRotator, mPositions[i], scale));
+	}
+	for (int i = numInstances - 1; i >= mPositions.Num(); i--)
+	{
+		mpInstances->RemoveInstance(i);
+	}
+
+	mInstanceTransforms.Reset(mPositions.Num());
+	for (const FVector& position : mPositions)
+	{
+		mInstanceTransforms.Add(FTransform(FRotator::ZeroRotator, position, scale));
+	}
+
+	if (mInstanceTransforms.Num() > 0)
+		mpInstances->BatchUpdateInstancesTransforms(0, mInstanceTransforms, true, true, true);
+}
+
+void UProjectileSubsystem::CreateVisualProxy()
+{
+	UWorld* world = GetWorld();
+	if (!world || world->GetNetMode() == NM_DedicatedServer)
+		return;
+
+	UStaticMesh* mesh = Cast<UStaticMesh>(ProjectileMesh.TryLoad());
+	if (!mesh)
+		return;
+
+	// A plain local actor, projectiles are fired on every machine so the proxy is never replicated
+	FActorSpawnParameters spawnParams;
+	spawnParams.ObjectFlags |= RF_Transient;
+	mpVisualProxy = world->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, spawnParams);
+	if (!mpVisualProxy)
+		return;
+
+	mpInstances = NewObject<UInstancedStaticMeshComponent>(mpVisualProxy);
+	mpInstances->SetStaticMesh(mesh);
+	mpInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	mpInstances->SetCastShadow(false);
+	mpInstances->SetMobility(EComponentMobility::Movable);
+
+	mpVisualProxy->SetRootComponent(mpInstances);
+	mpInstances->RegisterComponent();
+}
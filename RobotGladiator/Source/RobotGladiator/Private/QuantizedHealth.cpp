@@ -0,0 +1,44 @@
+/**
+ * @file QuantizedHealth.cpp
+ * @brief Defines a unit's health packed into a few bits as a fraction of its max health for replication
+ * @dependencies None
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "QuantizedHealth.h"
+
+void FQuantizedHealth::Set(float health, float maxHealth)
+{
+	if (health <= 0.0f || maxHealth <= 0.0f)
+	{
+		Value = 0;
+		return;
+	}
+
+	if (health >= maxHealth)
+	{
+		Value = MaxValue;
+		return;
+	}
+
+	// Anything alive rounds to at least 1 and anything hurt to at most MaxValue - 1
+	Value = (uint16)FMath::Clamp(FMath::RoundToInt(health / maxHealth * MaxValue), 1, MaxValue - 1);
+}
+
+float FQuantizedHealth::Get(float maxHealth) const
+{
+	return maxHealth * Value / MaxValue;
+}
+
+bool FQuantizedHealth::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// 10 bits rather than the 32 of a float
+	uint32 bits = Value;
+	Ar.SerializeBits(&bits, HealthBits);
+	Value = (uint16)(bits & MaxValue);
+
+	bOutSuccess = true;
+	return true;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file ReplicationSoak.cpp
+ * @brief Defines a console command that fills the arena with idle loot and units to load the server's replication
+ * @dependencies ArenaGrid.h, Weapon.h, Armor.h, Upgrade.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "ArenaGrid.h"
+#include "Weapon.h"
+#include "Armor.h"
+#include "Upgrade.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+
+#if !UE_BUILD_SHIPPING
+/** @brief Spawns replicated loot and grunts that sit idle, to load the server's replication by hand.
+ *		Usage: RobotGladiator.ReplicationSoak [loot] [units]
+ */
+static void SpawnReplicationSoak(const TArray<FString>& args, UWorld* world, FOutputDevice& ar)
+{
+	if (!world || world->GetNetMode() == NM_Client)
+	{
+		ar.Logf(TEXT("Replication soak has to be run on the server"));
+		return;
+	}
+
+	int numLoot = args.Num() > 0 ? FCString::Atoi(*args[0]) : 300;
+	int numUnits = args.Num() > 1 ? FCString::Atoi(*args[1]) : 200;
+
+	AArenaGrid* arena = AArenaGrid::FindArena(world);
+	int numTiles = arena ? arena->FloorPieces.Num() : 0;
+
+	FActorSpawnParameters spawnParams;
+	spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	int spawnedLoot = 0;
+	for (int i = 0; i < numLoot; i++)
+	{
+		// Spread over the arena's tiles, or a plain grid if there is no arena
+		FVector location = numTiles > 0 ? arena->GetTileCenter(i % numTiles) : FVector((i % 20) * 200.0f, (i / 20) * 200.0f, 0.0f);
+		location.Z += 100.0f;
+
+		AActor* loot = nullptr;
+		switch (i % 3)
+		{
+		case 0:
+			if (AWeapon* weapon = world->SpawnActor<AWeapon>(location, FRotator::ZeroRotator, spawnParams))
+			{
+				weapon->SetWeaponStats(10, COMMON, SWORD);
+				loot = weapon;
+			}
+			break;
+
+		case 1:
+			if (AArmor* armor = world->SpawnActor<AArmor>(location, FRotator::ZeroRotator, spawnParams))
+			{
+				armor->SetArmorStats(5, COMMON, CHEST);
+				loot = armor;
+			}
+			break;
+
+		default:
+			if (AUpgrade* upgrade = world->SpawnActor<AUpgrade>(location, FRotator::ZeroRotator, spawnParams))
+			{
+				upgrade->SetUpgradeStats(COMMON, DAMAGE, SWORD, 0.1f, 0.05f);
+				loot = upgrade;
+			}
+			break;
+		}
+
+		if (loot)
+		{
+			loot->SetReplicates(true);
+			spawnedLoot++;
+		}
+	}
+
+	int spawnedUnits = 0;
+	for (int i = 0; i < numUnits && numTiles > 0; i++)
+	{
+		if (arena->SpawnGrunt(i % numTiles))
+			spawnedUnits++;
+	}
+
+	ar.Logf(TEXT("Replication soak: spawned %d loot actors and %d units"), spawnedLoot, spawnedUnits);
+}
+
+static FAutoConsoleCommand GReplicationSoak(
+	TEXT("RobotGladiator.ReplicationSoak"),
+	TEXT("Spawns idle replicated loot and units to load server replication. Args: [loot=300] [units=200]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&SpawnReplicationSoak));
+#endif
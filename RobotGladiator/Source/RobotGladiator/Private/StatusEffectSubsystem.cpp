@@ -0,0 +1,362 @@
+/**
+ * @file StatusEffectSubsystem.cpp
+ * @brief Defines a world subsystem that runs every damage over time, heal over time and buff effect in one batched pass
+ * @dependencies WorldSubsystem.h, Tickable.h, BaseUnit.h, DamageQueueSubsystem.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "StatusEffectSubsystem.h"
+#include "BaseUnit.h"
+#include "DamageQueueSubsystem.h"
+#include "CombatRules.h"
+#include "Engine/World.h"
+
+UStatusEffectSubsystem::UStatusEffectSubsystem()
+{
+	// Overridden by DefaultGame.ini
+	EffectTickInterval = 0.25f;
+	MaxStepsPerFrame = 4;
+
+	mAccumulator = 0.0f;
+	mHasDirtySpeeds = false;
+}
+
+UStatusEffectSubsystem* UStatusEffectSubsystem::Get(const UObject* worldContextObject)
+{
+	UWorld* world = worldContextObject ? worldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UStatusEffectSubsystem>() : nullptr;
+}
+
+void UStatusEffectSubsystem::Deinitialize()
+{
+	mUnits.Empty();
+	mHealthDeltas.Empty();
+	mSpeedScales.Empty();
+	mEffectCounts.Empty();
+	mSpeedDirty.Empty();
+
+	mEffectUnits.Empty();
+	mEffectIds.Empty();
+	mEffectRates.Empty();
+	mEffectSpeeds.Empty();
+	mEffectTimeLeft.Empty();
+	mEffectStacks.Empty();
+	mEffectStacking.Empty();
+
+	Super::Deinitialize();
+}
+
+void UStatusEffectSubsystem::Tick(float DeltaTime)
+{
+	float stepLength = FMath::Max(EffectTickInterval, KINDA_SMALL_NUMBER);
+
+	// Effects tick at a fixed rate no matter the frame rate, time past the step limit is dropped
+	mAccumulator = FMath::Min(mAccumulator + DeltaTime, stepLength * MaxStepsPerFrame);
+	while (mAccumulator >= stepLength)
+	{
+		mAccumulator -= stepLength;
+		StepEffects(stepLength);
+	}
+
+	if (mHasDirtySpeeds)
+		ApplySpeedChanges();
+}
+
+bool UStatusEffectSubsystem::IsTickable() const
+{
+	return !IsTemplate() && mUnits.Num() > 0;
+}
+
+UWorld* UStatusEffectSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UStatusEffectSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStatusEffectSubsystem, STATGROUP_Tickables);
+}
+
+bool UStatusEffectSubsystem::ApplyEffect(ABaseUnit* target, const FStatusEffectSpec& spec)
+{
+	// Only the server runs effects
+	if (!IsValid(target) || !target->mIsActive || !target->HasAuthority() || spec.EffectId == NAME_None)
+		return false;
+
+	int unitHandle = FindOrAddUnit(target);
+	int effect = FindEffect(unitHandle, spec.EffectId);
+	int maxStacks = FMath::Max(spec.MaxStacks, 1);
+	float duration = spec.Duration > 0.0f ? spec.Duration : -1.0f;
+
+	if (effect == INDEX_NONE)
+	{
+		AddEffectRow(unitHandle, spec);
+		return true;
+	}
+
+	// Only speed effects change the unit's speed, damage and heal over time leave it alone
+	bool speedChanged = false;
+	switch (spec.Stacking)
+	{
+	case STACK_INTENSITY:
+	{
+		int stacks = CombatRules::AddStack(mEffectStacks[effect], maxStacks);
+		speedChanged = stacks != mEffectStacks[effect] && mEffectSpeeds[effect] != 1.0f;
+		mEffectStacks[effect] = stacks;
+		mEffectTimeLeft[effect] = duration;
+		break;
+	}
+
+	case STACK_INDEPENDENT:
+		// Once the cap is reached the instance closest to running out is replaced
+		if (GetStacks(target, spec.EffectId) < maxStacks)
+		{
+			AddEffectRow(unitHandle, spec);
+			return true;
+		}
+
+		speedChanged = mEffectSpeeds[effect] != spec.SpeedMultiplier;
+		mEffectRates[effect] = spec.HealthPerSecond;
+		mEffectSpeeds[effect] = spec.SpeedMultiplier;
+		mEffectTimeLeft[effect] = duration;
+		break;
+
+	default:
+	{
+		// Keep whichever rate and speed are stronger
+		float speed = mEffectSpeeds[effect];
+		CombatRules::KeepStronger(mEffectRates[effect], spec.HealthPerSecond, 0.0f);
+		CombatRules::KeepStronger(mEffectSpeeds[effect], spec.SpeedMultiplier, 1.0f);
+		speedChanged = mEffectSpeeds[effect] != speed;
+		mEffectTimeLeft[effect] = duration;
+		break;
+	}
+	}
+
+	if (speedChanged)
+	{
+		mSpeedDirty[unitHandle] = true;
+		mHasDirtySpeeds = true;
+	}
+
+	return true;
+}
+
+int UStatusEffectSubsystem::RemoveEffect(ABaseUnit* target, FName effectId)
+{
+	if (!target || !mUnits.IsValidIndex(target->mStatusHandle) || mUnits[target->mStatusHandle] != target)
+		return 0;
+
+	int unitHandle = target->mStatusHandle;
+	int removed = 0;
+
+	// Backwards so the row swapped into a removed slot has already been checked
+	for (int i = mEffectUnits.Num() - 1; i >= 0; i--)
+	{
+		if (mEffectUnits[i] == unitHandle && mEffectIds[i] == effectId)
+		{
+			RemoveEffectRow(i);
+			removed++;
+		}
+	}
+
+	if (mHasDirtySpeeds)
+		ApplySpeedChanges();
+
+	return removed;
+}
+
+int UStatusEffectSubsystem::GetStacks(const ABaseUnit* target, FName effectId) const
+{
+	if (!target || !mUnits.IsValidIndex(target->mStatusHandle) || mUnits[target->mStatusHandle] != target)
+		return 0;
+
+	int stacks = 0;
+	for (int i = 0; i < mEffectUnits.Num(); i++)
+	{
+		if (mEffectUnits[i] == target->mStatusHandle && mEffectIds[i] == effectId)
+			stacks += mEffectStacks[i];
+	}
+
+	return stacks;
+}
+
+void UStatusEffectSubsystem::RemoveUnit(ABaseUnit* unit)
+{
+	if (!unit || !mUnits.IsValidIndex(unit->mStatusHandle) || mUnits[unit->mStatusHandle] != unit)
+		return;
+
+	int handle = unit->mStatusHandle;
+	int last = mUnits.Num() - 1;
+
+	for (int i = mEffectUnits.Num() - 1; i >= 0; i--)
+	{
+		if (mEffectUnits[i] == handle)
+			RemoveEffectRow(i);
+	}
+
+	// Put the unit back to its normal speed, a pooled unit shouldn't come back slowed
+	unit->SetSpeedScale(1.0f);
+
+	unit->mStatusHandle = INDEX_NONE;
+
+	mUnits.RemoveAtSwap(handle, 1, false);
+	mHealthDeltas.RemoveAtSwap(handle, 1, false);
+	mSpeedScales.RemoveAtSwap(handle, 1, false);
+	mEffectCounts.RemoveAtSwap(handle, 1, false);
+	mSpeedDirty.RemoveAtSwap(handle, 1, false);
+
+	// The unit that was swapped in has a new handle, and so do its effects
+	if (mUnits.IsValidIndex(handle))
+	{
+		mUnits[handle]->mStatusHandle = handle;
+		for (int& effectUnit : mEffectUnits)
+		{
+			if (effectUnit == last)
+				effectUnit = handle;
+		}
+	}
+}
+
+void UStatusEffectSubsystem::StepEffects(float stepLength)
+{
+	for (float& delta : mHealthDeltas)
+	{
+		delta = 0.0f;
+	}
+
+	// Add up every effect into its unit's total and count down the timed ones
+	for (int i = mEffectUnits.Num() - 1; i >= 0; i--)
+	{
+		mHealthDeltas[mEffectUnits[i]] += mEffectRates[i] * mEffectStacks[i] * stepLength;
+
+		if (mEffectTimeLeft[i] < 0.0f)
+			continue;
+
+		// The step an effect runs out on still counts, so a 1 second effect applies a full second of health
+		mEffectTimeLeft[i] -= stepLength;
+		if (mEffectTimeLeft[i] <= KINDA_SMALL_NUMBER)
+			RemoveEffectRow(i);
+	}
+
+	// Each unit's health changes once per step however many effects it has
+	UDamageQueueSubsystem* damageQueue = UDamageQueueSubsystem::Get(this);
+	for (int i = 0; i < mUnits.Num(); i++)
+	{
+		ABaseUnit* unit = mUnits[i];
+		float delta = mHealthDeltas[i];
+		if (delta == 0.0f || !IsValid(unit))
+			continue;
+
+		if (delta > 0.0f)
+			unit->Heal(delta);
+		else if (damageQueue)
+			damageQueue->QueueDamage(unit, -delta);
+		else
+			unit->TakeDamage_Unit(-delta);
+	}
+}
+
+int UStatusEffectSubsystem::FindOrAddUnit(ABaseUnit* unit)
+{
+	if (mUnits.IsValidIndex(unit->mStatusHandle) && mUnits[unit->mStatusHandle] == unit)
+		return unit->mStatusHandle;
+
+	unit->mStatusHandle = mUnits.Add(unit);
+	mHealthDeltas.Add(0.0f);
+	mSpeedScales.Add(1.0f);
+	mEffectCounts.Add(0);
+	mSpeedDirty.Add(false);
+
+	return unit->mStatusHandle;
+}
+
+int UStatusEffectSubsystem::FindEffect(int unitHandle, FName effectId) const
+{
+	if (mEffectCounts[unitHandle] == 0)
+		return INDEX_NONE;
+
+	int found = INDEX_NONE;
+	for (int i = 0; i < mEffectUnits.Num(); i++)
+	{
+		if (mEffectUnits[i] != unitHandle || mEffectIds[i] != effectId)
+			continue;
+
+		// Independent effects have several rows, hand back the one that would run out first
+		if (found == INDEX_NONE || (mEffectTimeLeft[i] >= 0.0f && (mEffectTimeLeft[found] < 0.0f || mEffectTimeLeft[i] < mEffectTimeLeft[found])))
+			found = i;
+
+		if (mEffectStacking[i] != STACK_INDEPENDENT)
+			break;
+	}
+
+	return found;
+}
+
+void UStatusEffectSubsystem::AddEffectRow(int unitHandle, const FStatusEffectSpec& spec)
+{
+	mEffectUnits.Add(unitHandle);
+	mEffectIds.Add(spec.EffectId);
+	mEffectRates.Add(spec.HealthPerSecond);
+	mEffectSpeeds.Add(spec.SpeedMultiplier);
+	mEffectTimeLeft.Add(spec.Duration > 0.0f ? spec.Duration : -1.0f);
+	mEffectStacks.Add(1);
+	mEffectStacking.Add(spec.Stacking);
+
+	mEffectCounts[unitHandle]++;
+	if (spec.SpeedMultiplier != 1.0f)
+	{
+		mSpeedDirty[unitHandle] = true;
+		mHasDirtySpeeds = true;
+	}
+}
+
+void UStatusEffectSubsystem::RemoveEffectRow(int effect)
+{
+	int unitHandle = mEffectUnits[effect];
+	mEffectCounts[unitHandle]--;
+
+	if (mEffectSpeeds[effect] != 1.0f)
+	{
+		mSpeedDirty[unitHandle] = true;
+		mHasDirtySpeeds = true;
+	}
+
+	mEffectUnits.RemoveAtSwap(effect, 1, false);
+	mEffectIds.RemoveAtSwap(effect, 1, false);
+	mEffectRates.RemoveAtSwap(effect, 1, false);
+	mEffectSpeeds.RemoveAtSwap(effect, 1, false);
+	mEffectTimeLeft.RemoveAtSwap(effect, 1, false);
+	mEffectStacks.RemoveAtSwap(effect, 1, false);
+	mEffectStacking.RemoveAtSwap(effect, 1, false);
+}
+
+void UStatusEffectSubsystem::ApplySpeedChanges()
+{
+	mHasDirtySpeeds = false;
+
+	for (float& scale : mSpeedScales)
+	{
+		scale = 1.0f;
+	}
+
+	for (int i = 0; i < mEffectUnits.Num(); i++)
+	{
+		if (mSpeedDirty[mEffectUnits[i]] && mEffectSpeeds[i] != 1.0f)
+			mSpeedScales[mEffectUnits[i]] *= FMath::Pow(mEffectSpeeds[i], mEffectStacks[i]);
+	}
+
+	for (int i = 0; i < mUnits.Num(); i++)
+	{
+		if (!mSpeedDirty[i])
+			continue;
+
+		mSpeedDirty[i] = false;
+
+		// The scale is applied on top of whatever walk speed the unit sets itself, by its movement component
+		if (IsValid(mUnits[i]))
+			mUnits[i]->SetSpeedScale(mSpeedScales[i]);
+	}
+}
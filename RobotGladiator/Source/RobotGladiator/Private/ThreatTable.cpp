@@ -0,0 +1,207 @@
+/**
+ * @file ThreatTable.cpp
+ * @brief Defines a threat table that ranks the actors a unit is fighting by how much threat they have built up
+ * @dependencies None
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "ThreatTable.h"
+#include "GameFramework/Actor.h"
+
+// Below this the shared scale is folded back into the stored values
+static const float MIN_THREAT_SCALE = 1e-4f;
+
+FThreatTable::FThreatTable()
+{
+	mScale = 1.0f;
+}
+
+void FThreatTable::AddThreat(AActor* source, float amount)
+{
+	if (!source || amount <= 0.0f)
+		return;
+
+	int* index = mIndices.Find(source);
+
+	// A destroyed actor's address can be reused, the old entry isn't this source's threat
+	if (index && mSources[*index].Get() != source)
+	{
+		RemoveAt(*index);
+		index = nullptr;
+	}
+
+	if (!index)
+	{
+		int newIndex = mSources.Add(source);
+		mKeys.Add(source);
+		mValues.Add(amount / mScale);
+		mIndices.Add(source, newIndex);
+		SiftUp(newIndex);
+		return;
+	}
+
+	// Threat only ever goes up here so the entry can only move towards the root
+	int current = *index;
+	mValues[current] += amount / mScale;
+	SiftUp(current);
+}
+
+void FThreatTable::Decay(float scale)
+{
+	mScale *= FMath::Clamp(scale, 0.0f, 1.0f);
+
+	if (mScale < MIN_THREAT_SCALE)
+		Renormalize();
+}
+
+bool FThreatTable::Remove(const AActor* source)
+{
+	int* index = mIndices.Find(source);
+	if (!index)
+		return false;
+
+	RemoveAt(*index);
+	return true;
+}
+
+void FThreatTable::RemoveStale(float minThreat)
+{
+	// Removing reorders the heap, so find every stale entry before taking any out
+	TArray<const AActor*, TInlineAllocator<8>> stale;
+	for (int i = 0; i < mSources.Num(); i++)
+	{
+		if (!mSources[i].IsValid() || mValues[i] * mScale < minThreat)
+			stale.Add(mKeys[i]);
+	}
+
+	for (const AActor* key : stale)
+	{
+		Remove(key);
+	}
+}
+
+void FThreatTable::Reset()
+{
+	mSources.Reset();
+	mKeys.Reset();
+	mValues.Reset();
+	mIndices.Reset();
+	mScale = 1.0f;
+}
+
+AActor* FThreatTable::GetTop() const
+{
+	return mSources.Num() > 0 ? mSources[0].Get() : nullptr;
+}
+
+float FThreatTable::GetThreat(const AActor* source) const
+{
+	const int* index = mIndices.Find(source);
+	return index ? mValues[*index] * mScale : 0.0f;
+}
+
+void FThreatTable::GetTopK(int count, TArray<AActor*>& outSources) const
+{
+	outSources.Reset();
+	if (count <= 0 || mSources.Num() == 0)
+		return;
+
+	// Walk the heap from the root, always taking the best entry seen so far. Only the children of entries already
+	// taken can be next, so this looks at about 2k entries instead of all of them
+	auto higherThreat = [this](int a, int b) { return mValues[a] > mValues[b]; };
+
+	TArray<int, TInlineAllocator<16>> frontier;
+	frontier.HeapPush(0, higherThreat);
+
+	while (frontier.Num() > 0 && outSources.Num() < count)
+	{
+		int index;
+		frontier.HeapPop(index, higherThreat, false);
+
+		if (AActor* source = mSources[index].Get())
+			outSources.Add(source);
+
+		int child = index * 2 + 1;
+		if (child < mSources.Num())
+			frontier.HeapPush(child, higherThreat);
+		if (child + 1 < mSources.Num())
+			frontier.HeapPush(child + 1, higherThreat);
+	}
+}
+
+void FThreatTable::SiftUp(int index)
+{
+	while (index > 0)
+	{
+		int parent = (index - 1) / 2;
+		if (mValues[parent] >= mValues[index])
+			break;
+
+		SwapEntries(index, parent);
+		index = parent;
+	}
+}
+
+void FThreatTable::SiftDown(int index)
+{
+	int num = mSources.Num();
+	while (true)
+	{
+		int largest = index;
+		int left = index * 2 + 1;
+		int right = left + 1;
+
+		if (left < num && mValues[left] > mValues[largest])
+			largest = left;
+		if (right < num && mValues[right] > mValues[largest])
+			largest = right;
+
+		if (largest == index)
+			break;
+
+		SwapEntries(index, largest);
+		index = largest;
+	}
+}
+
+void FThreatTable::SwapEntries(int a, int b)
+{
+	mSources.Swap(a, b);
+	mKeys.Swap(a, b);
+	mValues.Swap(a, b);
+
+	mIndices.Add(mKeys[a], a);
+	mIndices.Add(mKeys[b], b);
+}
+
+void FThreatTable::RemoveAt(int index)
+{
+	int last = mSources.Num() - 1;
+
+	if (index != last)
+		SwapEntries(index, last);
+
+	mIndices.Remove(mKeys[last]);
+	mSources.RemoveAt(last, 1, false);
+	mKeys.RemoveAt(last, 1, false);
+	mValues.RemoveAt(last, 1, false);
+
+	// The entry moved into the slot could belong further up or further down
+	if (index < last)
+	{
+		SiftUp(index);
+		SiftDown(index);
+	}
+}
+
+void FThreatTable::Renormalize()
+{
+	for (float& value : mValues)
+	{
+		value *= mScale;
+	}
+
+	mScale = 1.0f;
+}
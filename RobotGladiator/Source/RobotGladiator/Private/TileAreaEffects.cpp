@@ -0,0 +1,77 @@
+/**
+ * @file TileAreaEffects.cpp
+ * @brief Defines the tile keyed area effects (healing and toxic tiles) applied by the arena grid
+ * @dependencies None
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "TileAreaEffects.h"
+
+FTileAreaEffects::FTileAreaEffects()
+{
+}
+
+void FTileAreaEffects::Init(int numTiles)
+{
+	mHealRates.Init(0.0f, numTiles);
+	mDamageRates.Init(0.0f, numTiles);
+	mEffectCounts.Init(0, numTiles);
+	mActiveTiles.Reset();
+	mTimedEffects.Reset();
+}
+
+void FTileAreaEffects::Reset()
+{
+	Init(mHealRates.Num());
+}
+
+void FTileAreaEffects::AddEffect(const FTileEffect& effect)
+{
+	if (!mHealRates.IsValidIndex(effect.Tile))
+		return;
+
+	ApplyRates(effect, 1.0f);
+
+	// Only effects with a duration have to be counted down
+	if (effect.TimeLeft > 0.0f)
+		mTimedEffects.Add(effect);
+}
+
+void FTileAreaEffects::Tick(float deltaTime, TArray<FTileEffect>& outExpired)
+{
+	outExpired.Reset();
+
+	for (int i = mTimedEffects.Num() - 1; i >= 0; i--)
+	{
+		mTimedEffects[i].TimeLeft -= deltaTime;
+		if (mTimedEffects[i].TimeLeft <= 0.0f)
+		{
+			ApplyRates(mTimedEffects[i], -1.0f);
+			outExpired.Add(mTimedEffects[i]);
+			mTimedEffects.RemoveAtSwap(i, 1, false);
+		}
+	}
+}
+
+void FTileAreaEffects::ApplyRates(const FTileEffect& effect, float scale)
+{
+	int tile = effect.Tile;
+
+	mHealRates[tile] += effect.HealPerSecond * scale;
+	mDamageRates[tile] += effect.DamagePerSecond * scale;
+
+	// Keep the active tile list in sync with the number of effects on each tile
+	if (scale > 0.0f)
+	{
+		if (mEffectCounts[tile]++ == 0)
+			mActiveTiles.Add(tile);
+	}
+	else if (--mEffectCounts[tile] == 0)
+	{
+		mHealRates[tile] = 0.0f;
+		mDamageRates[tile] = 0.0f;
+		mActiveTiles.RemoveSingleSwap(tile, false);
+	}
+}
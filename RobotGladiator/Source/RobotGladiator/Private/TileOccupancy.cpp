@@ -0,0 +1,98 @@
+/**
+ * @file TileOccupancy.cpp
+ * @brief Defines the tile occupancy index which tracks which units are standing on which hex
+ * @dependencies BaseUnit.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "TileOccupancy.h"
+
+FTileOccupancy::FTileOccupancy()
+{
+}
+
+void FTileOccupancy::ResetTiles(int numTiles)
+{
+	mTileUnits.Reset();
+	mTileUnits.SetNum(numTiles);
+
+	// Every unit is now off the grid until it is moved back on
+	for (int handle = 0; handle < mUnits.Num(); handle++)
+	{
+		mUnitTiles[handle] = INDEX_NONE;
+		mSlotInTile[handle] = INDEX_NONE;
+	}
+}
+
+int FTileOccupancy::AddUnit(ABaseUnit* unit, int tile)
+{
+	int handle;
+
+	// Reuse a free handle if there is one
+	if (mFreeHandles.Num() > 0)
+	{
+		handle = mFreeHandles.Pop(false);
+		mUnits[handle] = unit;
+		mUnitTiles[handle] = INDEX_NONE;
+		mSlotInTile[handle] = INDEX_NONE;
+	}
+	else
+	{
+		handle = mUnits.Add(unit);
+		mUnitTiles.Add(INDEX_NONE);
+		mSlotInTile.Add(INDEX_NONE);
+	}
+
+	AddToTile(handle, tile);
+	return handle;
+}
+
+void FTileOccupancy::RemoveUnit(int handle)
+{
+	if (!GetUnit(handle))
+		return;
+
+	RemoveFromTile(handle);
+
+	mUnits[handle] = nullptr;
+	mFreeHandles.Add(handle);
+}
+
+void FTileOccupancy::MoveUnit(int handle, int tile)
+{
+	if (!GetUnit(handle) || mUnitTiles[handle] == tile)
+		return;
+
+	RemoveFromTile(handle);
+	AddToTile(handle, tile);
+}
+
+void FTileOccupancy::RemoveFromTile(int handle)
+{
+	int tile = mUnitTiles[handle];
+	if (!mTileUnits.IsValidIndex(tile))
+		return;
+
+	// Swap the last unit on the tile into this unit's slot to keep the list compact
+	TArray<int>& tileUnits = mTileUnits[tile];
+	int slot = mSlotInTile[handle];
+	int last = tileUnits.Last();
+
+	tileUnits[slot] = last;
+	mSlotInTile[last] = slot;
+	tileUnits.Pop(false);
+
+	mUnitTiles[handle] = INDEX_NONE;
+	mSlotInTile[handle] = INDEX_NONE;
+}
+
+void FTileOccupancy::AddToTile(int handle, int tile)
+{
+	if (!mTileUnits.IsValidIndex(tile))
+		return;
+
+	mSlotInTile[handle] = mTileUnits[tile].Add(handle);
+	mUnitTiles[handle] = tile;
+}
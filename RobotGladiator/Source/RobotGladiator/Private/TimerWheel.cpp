@@ -0,0 +1,201 @@
+/**
+ * @file TimerWheel.cpp
+ * @brief Defines a hierarchical timer wheel for gameplay cooldowns
+ * @dependencies None
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "TimerWheel.h"
+
+FTimerWheel::FTimerWheel(float tickLength)
+{
+	mTickLength = FMath::Max(tickLength, KINDA_SMALL_NUMBER);
+	mCurrentTick = 0;
+	mAccumulator = 0.0f;
+	mNumTimers = 0;
+
+	for (int& head : mSlotHeads)
+	{
+		head = INDEX_NONE;
+	}
+}
+
+uint64 FTimerWheel::AddTimer(float delay, int userData)
+{
+	int node;
+	if (mFreeNodes.Num() > 0)
+	{
+		node = mFreeNodes.Pop(false);
+	}
+	else
+	{
+		node = mNodes.AddZeroed();
+	}
+
+	// Round up so a timer never fires early, and always wait at least one tick
+	uint64 ticks = (uint64)FMath::Max(FMath::CeilToInt((delay + mAccumulator) / mTickLength), 1);
+
+	FTimerNode& timer = mNodes[node];
+	timer.ExpireTick = mCurrentTick + ticks;
+	timer.UserData = userData;
+
+	// Skip 0 so a handle of 0 is never valid
+	timer.Serial = FMath::Max(timer.Serial + 1, 1u);
+
+	Link(node);
+	mNumTimers++;
+
+	return ((uint64)timer.Serial << 32) | (uint32)node;
+}
+
+bool FTimerWheel::CancelTimer(uint64 handle)
+{
+	int node = FindNode(handle);
+	if (node == INDEX_NONE)
+		return false;
+
+	Unlink(node);
+	mFreeNodes.Add(node);
+	mNumTimers--;
+
+	return true;
+}
+
+void FTimerWheel::SetUserData(uint64 handle, int userData)
+{
+	int node = FindNode(handle);
+	if (node != INDEX_NONE)
+		mNodes[node].UserData = userData;
+}
+
+void FTimerWheel::Advance(float deltaTime, TArray<int>& outExpired)
+{
+	outExpired.Reset();
+	mAccumulator += deltaTime;
+
+	while (mAccumulator >= mTickLength)
+	{
+		mAccumulator -= mTickLength;
+		mCurrentTick++;
+
+		// Each time a level wraps around, the next slot of the level above it is due to be split up
+		for (int level = 1; level < NUM_LEVELS; level++)
+		{
+			if ((mCurrentTick & ((1ull << (SLOT_BITS * level)) - 1)) != 0)
+				break;
+
+			Cascade(level, (mCurrentTick >> (SLOT_BITS * level)) & SLOT_MASK);
+		}
+
+		// Everything left in the current slot expires on this tick
+		int& head = mSlotHeads[mCurrentTick & SLOT_MASK];
+		while (head != INDEX_NONE)
+		{
+			int node = head;
+			outExpired.Add(mNodes[node].UserData);
+
+			Unlink(node);
+			mFreeNodes.Add(node);
+			mNumTimers--;
+		}
+	}
+}
+
+void FTimerWheel::Reset()
+{
+	// Keep the nodes so their serials carry on and old handles stay invalid
+	mFreeNodes.Reset();
+	for (int i = 0; i < mNodes.Num(); i++)
+	{
+		mNodes[i].Slot = INDEX_NONE;
+		mFreeNodes.Add(i);
+	}
+
+	mAccumulator = 0.0f;
+	mNumTimers = 0;
+
+	for (int& head : mSlotHeads)
+	{
+		head = INDEX_NONE;
+	}
+}
+
+float FTimerWheel::GetTimeLeft(uint64 handle) const
+{
+	int node = FindNode(handle);
+	if (node == INDEX_NONE)
+		return 0.0f;
+
+	return FMath::Max((mNodes[node].ExpireTick - mCurrentTick) * mTickLength - mAccumulator, 0.0f);
+}
+
+int FTimerWheel::FindNode(uint64 handle) const
+{
+	int node = (int)(uint32)handle;
+	uint32 serial = (uint32)(handle >> 32);
+
+	if (!mNodes.IsValidIndex(node) || mNodes[node].Serial != serial || mNodes[node].Slot == INDEX_NONE)
+		return INDEX_NONE;
+
+	return node;
+}
+
+void FTimerWheel::Link(int node)
+{
+	FTimerNode& timer = mNodes[node];
+	uint64 delta = timer.ExpireTick - mCurrentTick;
+
+	// Find the first level with enough range, timers past the last level wait in its farthest slot
+	int level = 0;
+	while (level < NUM_LEVELS - 1 && delta >= (1ull << (SLOT_BITS * (level + 1))))
+	{
+		level++;
+	}
+
+	uint64 slotTick = timer.ExpireTick;
+	uint64 maxDelta = (1ull << (SLOT_BITS * NUM_LEVELS)) - 1;
+	if (delta > maxDelta)
+		slotTick = mCurrentTick + maxDelta;
+
+	timer.Slot = level * NUM_SLOTS + ((slotTick >> (SLOT_BITS * level)) & SLOT_MASK);
+	timer.Prev = INDEX_NONE;
+	timer.Next = mSlotHeads[timer.Slot];
+
+	if (timer.Next != INDEX_NONE)
+		mNodes[timer.Next].Prev = node;
+
+	mSlotHeads[timer.Slot] = node;
+}
+
+void FTimerWheel::Unlink(int node)
+{
+	FTimerNode& timer = mNodes[node];
+
+	if (timer.Prev != INDEX_NONE)
+		mNodes[timer.Prev].Next = timer.Next;
+	else
+		mSlotHeads[timer.Slot] = timer.Next;
+
+	if (timer.Next != INDEX_NONE)
+		mNodes[timer.Next].Prev = timer.Prev;
+
+	timer.Slot = INDEX_NONE;
+	timer.Prev = INDEX_NONE;
+	timer.Next = INDEX_NONE;
+}
+
+void FTimerWheel::Cascade(int level, int slot)
+{
+	// Take the whole list first since relinking can put timers back into this level
+	int node = mSlotHeads[level * NUM_SLOTS + slot];
+	mSlotHeads[level * NUM_SLOTS + slot] = INDEX_NONE;
+
+	while (node != INDEX_NONE)
+	{
+		int next = mNodes[node].Next;
+		Link(node);
+		node = next;
+	}
+}
@@ -0,0 +1,382 @@
+/**
+ * @file UnitAIManager.cpp
+ * @brief Defines the AI manager which updates every gladiator and grunt in one batched pass instead of per actor Tick,
+ *		thinking less often for units that are far away from every player
+ * @dependencies BaseUnit.h, PlayerRegistrySubsystem.h, TimerWheel.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "UnitAIManager.h"
+#include "BaseUnit.h"
+#include "PlayerRegistrySubsystem.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+
+UUnitAIManager::UUnitAIManager()
+{
+	RetargetsPerFrame = 8;
+	ParallelThreshold = 64;
+
+	// Overridden by DefaultGame.ini
+	NearDistance = 3000.0f;
+	FarDistance = 8000.0f;
+	TierHysteresis = 500.0f;
+	MidDecisionInterval = 0.25f;
+	FarDecisionInterval = 1.0f;
+	NearMovementTickInterval = 0.0f;
+	MidMovementTickInterval = 0.05f;
+	FarMovementTickInterval = 0.2f;
+
+	mRetargetCursor = 0;
+	mIsUpdating = false;
+}
+
+UUnitAIManager* UUnitAIManager::Get(const UObject* worldContextObject)
+{
+	UWorld* world = worldContextObject ? worldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UUnitAIManager>() : nullptr;
+}
+
+void UUnitAIManager::Deinitialize()
+{
+	mUnits.Empty();
+	mTargets.Empty();
+	mPositions.Empty();
+	mTargetPositions.Empty();
+	mDistances.Empty();
+	mCooldownTimers.Empty();
+	mCooldownWheel.Reset();
+	mFlags.Empty();
+	mPlayerDistances.Empty();
+	mDecisionTimers.Empty();
+	mTiers.Empty();
+	mPlayerPositions.Empty();
+
+	Super::Deinitialize();
+}
+
+void UUnitAIManager::Tick(float DeltaTime)
+{
+	mIsUpdating = true;
+
+	UpdateCooldowns(DeltaTime);
+	GatherState();
+	UpdateTargets();
+	UpdateDecisions(DeltaTime);
+	ApplyDecisions();
+
+	mIsUpdating = false;
+	RemovePendingUnits();
+}
+
+bool UUnitAIManager::IsTickable() const
+{
+	return !IsTemplate() && mUnits.Num() > 0;
+}
+
+UWorld* UUnitAIManager::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UUnitAIManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UUnitAIManager, STATGROUP_Tickables);
+}
+
+void UUnitAIManager::RegisterUnit(ABaseUnit* unit)
+{
+	if (!unit || (mUnits.IsValidIndex(unit->mAIHandle) && mUnits[unit->mAIHandle] == unit))
+		return;
+
+	// New units pick a target straight away instead of waiting for their turn
+	AActor* target = FindTarget(unit);
+
+	unit->mAIHandle = mUnits.Add(unit);
+	mTargets.Add(target);
+	mPositions.Add(unit->GetActorLocation());
+	mTargetPositions.Add(target ? target->GetActorLocation() : FVector::ZeroVector);
+	mDistances.Add(0.0f);
+	mCooldownTimers.Add(0);
+	mFlags.Add(AI_NONE);
+	mPlayerDistances.Add(0.0f);
+	mDecisionTimers.Add(0.0f);
+
+	// Start in the near tier, the first update moves the unit out if it's far away
+	mTiers.Add(AI_LOD_NEAR);
+	unit->SetAILOD(AI_LOD_NEAR, GetMovementTickInterval(AI_LOD_NEAR));
+
+	StartCooldown(unit->mAIHandle, unit->GetAIStartCooldown());
+}
+
+void UUnitAIManager::UnregisterUnit(ABaseUnit* unit)
+{
+	if (!unit || !mUnits.IsValidIndex(unit->mAIHandle) || mUnits[unit->mAIHandle] != unit)
+		return;
+
+	int handle = unit->mAIHandle;
+	unit->mAIHandle = INDEX_NONE;
+
+	// Clear the slot now, the arrays are compacted once nothing is walking them
+	mUnits[handle] = nullptr;
+	mTargets[handle] = nullptr;
+	StartCooldown(handle, 0.0f);
+	mPendingRemovals.Add(handle);
+
+	if (!mIsUpdating)
+		RemovePendingUnits();
+}
+
+void UUnitAIManager::SetTarget(ABaseUnit* unit, AActor* target)
+{
+	if (!unit || !mUnits.IsValidIndex(unit->mAIHandle) || mUnits[unit->mAIHandle] != unit)
+		return;
+
+	int handle = unit->mAIHandle;
+	mTargets[handle] = target;
+
+	if (target)
+	{
+		mTargetPositions[handle] = target->GetActorLocation();
+		mFlags[handle] |= AI_HAS_TARGET;
+	}
+	else
+	{
+		mFlags[handle] &= ~AI_HAS_TARGET;
+	}
+}
+
+void UUnitAIManager::GatherState()
+{
+	mPlayerPositions.Reset();
+	if (UPlayerRegistrySubsystem* registry = UPlayerRegistrySubsystem::Get(this))
+	{
+		for (AActor* player : registry->GetPlayers())
+		{
+			if (IsValid(player))
+				mPlayerPositions.Add(player->GetActorLocation());
+		}
+	}
+
+	for (int i = 0; i < mUnits.Num(); i++)
+	{
+		ABaseUnit* unit = mUnits[i];
+		if (!unit)
+		{
+			mFlags[i] = AI_BUSY;
+			continue;
+		}
+
+		mPositions[i] = unit->GetActorLocation();
+
+		uint8 flags = unit->IsAIBusy() ? AI_BUSY : AI_NONE;
+		if (IsValid(mTargets[i]))
+		{
+			mTargetPositions[i] = mTargets[i]->GetActorLocation();
+			flags |= AI_HAS_TARGET;
+		}
+
+		mFlags[i] = flags;
+	}
+}
+
+void UUnitAIManager::UpdateTargets()
+{
+	int count = FMath::Min(RetargetsPerFrame, mUnits.Num());
+
+	// Pick up where last frame left off so every unit gets a turn
+	for (int i = 0; i < count; i++)
+	{
+		mRetargetCursor = (mRetargetCursor + 1) % mUnits.Num();
+
+		ABaseUnit* unit = mUnits[mRetargetCursor];
+		if (!unit)
+			continue;
+
+		// Far units just keep walking towards the target they already have
+		if (mTiers[mRetargetCursor] == AI_LOD_FAR && (mFlags[mRetargetCursor] & AI_HAS_TARGET))
+			continue;
+
+		AActor* target = FindTarget(unit);
+		mTargets[mRetargetCursor] = target;
+
+		if (target)
+		{
+			mTargetPositions[mRetargetCursor] = target->GetActorLocation();
+			mFlags[mRetargetCursor] |= AI_HAS_TARGET;
+		}
+		else
+		{
+			mFlags[mRetargetCursor] &= ~AI_HAS_TARGET;
+		}
+	}
+}
+
+void UUnitAIManager::UpdateDecisions(float deltaTime)
+{
+	// Pure math on the gathered arrays, safe to split across worker threads
+	ParallelFor(mUnits.Num(), [this, deltaTime](int32 i)
+	{
+		// There are only ever a few players so checking all of them is cheaper than asking the registry
+		float closestDistSq = MAX_flt;
+		for (const FVector& playerPosition : mPlayerPositions)
+		{
+			closestDistSq = FMath::Min(closestDistSq, FVector::DistSquared(mPositions[i], playerPosition));
+		}
+		mPlayerDistances[i] = FMath::Sqrt(closestDistSq);
+
+		// Near units think every frame, the rest wait for their decision timer
+		mDecisionTimers[i] += deltaTime;
+		EAILODTier tier = (EAILODTier)mTiers[i];
+		if (mDecisionTimers[i] < GetDecisionInterval(tier))
+			return;
+
+		mDecisionTimers[i] = 0.0f;
+		mFlags[i] |= AI_THINK;
+
+		if (mFlags[i] & AI_HAS_TARGET)
+		{
+			mDistances[i] = FVector::Dist(mPositions[i], mTargetPositions[i]);
+
+			// Far units still act, only less often, ranged attacks are meant for them
+			if (!(mFlags[i] & AI_BUSY) && mCooldownTimers[i] == 0)
+				mFlags[i] |= AI_READY;
+		}
+	}, mUnits.Num() < ParallelThreshold);
+}
+
+void UUnitAIManager::ApplyDecisions()
+{
+	for (int i = 0; i < mUnits.Num(); i++)
+	{
+		ABaseUnit* unit = mUnits[i];
+		if (!unit)
+			continue;
+
+		// Changing tier touches the unit's components so it's done here rather than in the parallel pass
+		EAILODTier tier = GetTierForDistance(mPlayerDistances[i], (EAILODTier)mTiers[i]);
+		if (tier != mTiers[i])
+		{
+			mTiers[i] = tier;
+			unit->SetAILOD(tier, GetMovementTickInterval(tier));
+		}
+
+		if (!(mFlags[i] & AI_THINK))
+			continue;
+
+		unit->ReceiveAIState(mTargets[i], mDistances[i], mCooldownWheel.GetTimeLeft(mCooldownTimers[i]));
+
+		if (mFlags[i] & AI_READY)
+		{
+			// The unit hands back how long to wait before it acts again
+			float cooldown = unit->PerformAIAction(mDistances[i]);
+			if (cooldown >= 0.0f && mUnits[i] == unit)
+				StartCooldown(i, cooldown);
+		}
+	}
+}
+
+void UUnitAIManager::RemovePendingUnits()
+{
+	// Highest handles first so swapping never moves a handle that is still waiting to be removed
+	mPendingRemovals.Sort([](int a, int b) { return a > b; });
+
+	for (int handle : mPendingRemovals)
+	{
+		mUnits.RemoveAtSwap(handle, 1, false);
+		mTargets.RemoveAtSwap(handle, 1, false);
+		mPositions.RemoveAtSwap(handle, 1, false);
+		mTargetPositions.RemoveAtSwap(handle, 1, false);
+		mDistances.RemoveAtSwap(handle, 1, false);
+		mCooldownTimers.RemoveAtSwap(handle, 1, false);
+		mFlags.RemoveAtSwap(handle, 1, false);
+		mPlayerDistances.RemoveAtSwap(handle, 1, false);
+		mDecisionTimers.RemoveAtSwap(handle, 1, false);
+		mTiers.RemoveAtSwap(handle, 1, false);
+
+		// The unit that was swapped in has a new handle
+		if (mUnits.IsValidIndex(handle))
+		{
+			if (mUnits[handle])
+				mUnits[handle]->mAIHandle = handle;
+
+			mCooldownWheel.SetUserData(mCooldownTimers[handle], handle);
+		}
+	}
+
+	mPendingRemovals.Reset();
+}
+
+void UUnitAIManager::UpdateCooldowns(float deltaTime)
+{
+	// Only the timers that ran out are touched, units still cooling down aren't looked at
+	mCooldownWheel.Advance(deltaTime, mExpiredCooldowns);
+
+	for (int handle : mExpiredCooldowns)
+	{
+		if (mCooldownTimers.IsValidIndex(handle))
+			mCooldownTimers[handle] = 0;
+	}
+}
+
+void UUnitAIManager::StartCooldown(int handle, float cooldown)
+{
+	mCooldownWheel.CancelTimer(mCooldownTimers[handle]);
+	mCooldownTimers[handle] = cooldown > 0.0f ? mCooldownWheel.AddTimer(cooldown, handle) : 0;
+}
+
+AActor* UUnitAIManager::FindTarget(ABaseUnit* unit) const
+{
+	// Units with their own idea of who to fight get it, the rest go for the closest player
+	if (AActor* chosen = unit->ChooseAITarget())
+		return chosen;
+
+	UPlayerRegistrySubsystem* registry = UPlayerRegistrySubsystem::Get(this);
+	if (!registry)
+		return nullptr;
+
+	return registry->FindClosestPlayer(unit->GetActorLocation(), unit->GetAITargetClass(), unit);
+}
+
+EAILODTier UUnitAIManager::GetTierForDistance(float distance, EAILODTier currentTier) const
+{
+	// Make it harder to leave the current tier than to enter it
+	float nearDistance = NearDistance + (currentTier == AI_LOD_NEAR ? TierHysteresis : 0.0f);
+	float farDistance = FarDistance - (currentTier == AI_LOD_FAR ? TierHysteresis : 0.0f);
+
+	if (distance <= nearDistance)
+		return AI_LOD_NEAR;
+
+	if (distance >= farDistance)
+		return AI_LOD_FAR;
+
+	return AI_LOD_MID;
+}
+
+float UUnitAIManager::GetDecisionInterval(EAILODTier tier) const
+{
+	switch (tier)
+	{
+	case AI_LOD_MID:
+		return MidDecisionInterval;
+	case AI_LOD_FAR:
+		return FarDecisionInterval;
+	default:
+		return 0.0f;
+	}
+}
+
+float UUnitAIManager::GetMovementTickInterval(EAILODTier tier) const
+{
+	switch (tier)
+	{
+	case AI_LOD_MID:
+		return MidMovementTickInterval;
+	case AI_LOD_FAR:
+		return FarMovementTickInterval;
+	default:
+		return NearMovementTickInterval;
+	}
+}
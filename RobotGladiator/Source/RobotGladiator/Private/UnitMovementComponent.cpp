@@ -0,0 +1,23 @@
+/**
+ * @file UnitMovementComponent.cpp
+ * @brief Defines the movement component every unit uses, which scales the unit's own walk speed by its status effects
+ * @dependencies CharacterMovementComponent.h, BaseUnit.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "UnitMovementComponent.h"
+#include "BaseUnit.h"
+
+float UUnitMovementComponent::GetMaxSpeed() const
+{
+	float speed = Super::GetMaxSpeed();
+
+	// Only walking speed is affected by status effects
+	const ABaseUnit* unit = Cast<ABaseUnit>(CharacterOwner);
+	if (unit && (MovementMode == MOVE_Walking || MovementMode == MOVE_NavWalking))
+		speed *= unit->mSpeedScale;
+
+	return speed;
+}
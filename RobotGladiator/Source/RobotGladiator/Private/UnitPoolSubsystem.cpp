@@ -0,0 +1,139 @@
+/**
+ * @file UnitPoolSubsystem.cpp
+ * @brief Defines a world subsystem that recycles dead enemies instead of destroying and respawning them
+ * @dependencies WorldSubsystem.h, BaseUnit.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "UnitPoolSubsystem.h"
+#include "BaseUnit.h"
+#include "Engine/World.h"
+
+UUnitPoolSubsystem::UUnitPoolSubsystem()
+{
+	MaxPooledPerClass = 64;
+
+	PrewarmLocation = FVector(0.0f, 0.0f, -20000.0f);
+	PrewarmSpacing = 200.0f;
+}
+
+UUnitPoolSubsystem* UUnitPoolSubsystem::Get(const UObject* worldContextObject)
+{
+	UWorld* world = worldContextObject ? worldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UUnitPoolSubsystem>() : nullptr;
+}
+
+void UUnitPoolSubsystem::Deinitialize()
+{
+	mPools.Empty();
+
+	Super::Deinitialize();
+}
+
+ABaseUnit* UUnitPoolSubsystem::AcquireUnit(TSubclassOf<ABaseUnit> unitClass, FVector location, FRotator rotation, AActor* owner,
+	ESpawnActorCollisionHandlingMethod collisionHandling)
+{
+	if (!unitClass)
+		return nullptr;
+
+	// Reuse a pooled unit if there is one, skipping any that were destroyed while they waited
+	if (FUnitPoolList* pool = mPools.Find(unitClass))
+	{
+		while (pool->Units.Num() > 0)
+		{
+			ABaseUnit* unit = pool->Units.Pop(false);
+			if (!IsValid(unit))
+				continue;
+
+			// Pooled units have no collision, it has to be on to test whether the unit fits
+			FVector placedLocation = location;
+			unit->SetActorEnableCollision(true);
+			if (!AdjustPlacement(unit, collisionHandling, placedLocation, rotation))
+			{
+				// Doesn't fit, the same as a spawn that failed
+				unit->SetActorEnableCollision(false);
+				pool->Units.Add(unit);
+				return nullptr;
+			}
+
+			unit->SetOwner(owner);
+			unit->SetActorLocationAndRotation(placedLocation, rotation, false, nullptr, ETeleportType::ResetPhysics);
+			unit->ActivateUnit();
+			return unit;
+		}
+	}
+
+	FActorSpawnParameters spawnParams;
+	spawnParams.Owner = owner;
+	spawnParams.SpawnCollisionHandlingOverride = collisionHandling;
+
+	return GetWorld()->SpawnActor<ABaseUnit>(unitClass, location, rotation, spawnParams);
+}
+
+void UUnitPoolSubsystem::ReleaseUnit(ABaseUnit* unit)
+{
+	if (!IsValid(unit) || !unit->mIsActive)
+		return;
+
+	FUnitPoolList& pool = mPools.FindOrAdd(unit->GetClass());
+	if (pool.Units.Num() >= MaxPooledPerClass)
+	{
+		unit->Destroy();
+		return;
+	}
+
+	unit->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	unit->DeactivateUnit();
+	pool.Units.Add(unit);
+}
+
+void UUnitPoolSubsystem::PrewarmPool(TSubclassOf<ABaseUnit> unitClass, int count)
+{
+	if (!unitClass)
+		return;
+
+	count = FMath::Min(count, MaxPooledPerClass) - GetNumPooled(unitClass);
+
+	FActorSpawnParameters spawnParams;
+	spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	// Spawn fresh units rather than acquiring, acquiring would hand back the ones already in the pool.
+	// They are lined up out of sight so they don't land on the arena or on top of each other
+	for (int i = 0; i < count; i++)
+	{
+		FVector location = PrewarmLocation + FVector(i * PrewarmSpacing, 0.0f, 0.0f);
+		ReleaseUnit(GetWorld()->SpawnActor<ABaseUnit>(unitClass, location, FRotator::ZeroRotator, spawnParams));
+	}
+}
+
+bool UUnitPoolSubsystem::AdjustPlacement(ABaseUnit* unit, ESpawnActorCollisionHandlingMethod collisionHandling, FVector& location, FRotator rotation) const
+{
+	// Undefined falls back to the unit's own setting, as it does for SpawnActor
+	if (collisionHandling == ESpawnActorCollisionHandlingMethod::Undefined)
+		collisionHandling = unit->SpawnCollisionHandlingMethod;
+
+	UWorld* world = GetWorld();
+	switch (collisionHandling)
+	{
+	case ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn:
+		world->FindTeleportSpot(unit, location, rotation);
+		return true;
+
+	case ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding:
+		return world->FindTeleportSpot(unit, location, rotation);
+
+	case ESpawnActorCollisionHandlingMethod::DontSpawnIfColliding:
+		return !world->EncroachingBlockingGeometry(unit, location, rotation);
+
+	default:
+		return true;
+	}
+}
+
+int UUnitPoolSubsystem::GetNumPooled(TSubclassOf<ABaseUnit> unitClass) const
+{
+	const FUnitPoolList* pool = mPools.Find(unitClass);
+	return pool ? pool->Units.Num() : 0;
+}
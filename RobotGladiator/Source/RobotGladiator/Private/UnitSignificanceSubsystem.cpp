@@ -0,0 +1,145 @@
+/**
+ * @file UnitSignificanceSubsystem.cpp
+ * @brief Defines a world subsystem that rates how much each unit matters to the local player and feeds that to the
+ *		animation budget allocator
+ * @dependencies WorldSubsystem.h, Tickable.h, IAnimationBudgetAllocator.h, PlayerRegistrySubsystem.h, ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "UnitSignificanceSubsystem.h"
+#include "ArenaGrid.h"
+#include "BaseUnit.h"
+#include "PlayerRegistrySubsystem.h"
+#include "IAnimationBudgetAllocator.h"
+#include "AnimationBudgetAllocatorParameters.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+
+UUnitSignificanceSubsystem::UUnitSignificanceSubsystem()
+{
+	// Overridden by DefaultGame.ini
+	AnimationBudgetMs = 1.0f;
+	HalfSignificanceDistance = 3000.0f;
+	OffscreenScale = 0.1f;
+
+	mpArena = nullptr;
+	mIsAllocatorSetUp = false;
+}
+
+UUnitSignificanceSubsystem* UUnitSignificanceSubsystem::Get(const UObject* worldContextObject)
+{
+	UWorld* world = worldContextObject ? worldContextObject->GetWorld() : nullptr;
+	return world ? world->GetSubsystem<UUnitSignificanceSubsystem>() : nullptr;
+}
+
+void UUnitSignificanceSubsystem::Deinitialize()
+{
+	mpArena = nullptr;
+	mViewLocations.Empty();
+	mLocalPlayers.Empty();
+
+	Super::Deinitialize();
+}
+
+void UUnitSignificanceSubsystem::Tick(float DeltaTime)
+{
+	if (!mIsAllocatorSetUp)
+		SetupBudgetAllocator();
+
+	if (!IsValid(mpArena))
+		mpArena = AArenaGrid::FindArena(this);
+
+	IAnimationBudgetAllocator* allocator = IAnimationBudgetAllocator::Get(GetWorld());
+	if (!mpArena || !allocator)
+		return;
+
+	// The registry already knows every player, only the ones this machine controls matter for what it draws
+	mViewLocations.Reset();
+	mLocalPlayers.Reset();
+	if (UPlayerRegistrySubsystem* registry = UPlayerRegistrySubsystem::Get(this))
+	{
+		for (AActor* player : registry->GetPlayers())
+		{
+			APawn* pawn = Cast<APawn>(player);
+			if (IsValid(pawn) && pawn->IsLocallyControlled())
+			{
+				mViewLocations.Add(pawn->GetActorLocation());
+				mLocalPlayers.Add(pawn);
+			}
+		}
+	}
+
+	for (int handle = 0; handle < mpArena->Occupancy.GetMaxHandle(); handle++)
+	{
+		ABaseUnit* unit = mpArena->Occupancy.GetUnit(handle);
+		if (!unit)
+			continue;
+
+		USkeletalMeshComponentBudgeted* mesh = Cast<USkeletalMeshComponentBudgeted>(unit->GetMesh());
+		if (!mesh || !mesh->IsRegistered())
+			continue;
+
+		// Local players always animate at full rate
+		bool isLocalPlayer = mLocalPlayers.Contains(unit);
+		allocator->SetComponentSignificance(mesh, isLocalPlayer ? 1.0f : CalculateSignificance(unit), isLocalPlayer);
+	}
+}
+
+bool UUnitSignificanceSubsystem::IsTickable() const
+{
+	UWorld* world = GetWorld();
+	return !IsTemplate() && world && world->GetNetMode() != NM_DedicatedServer;
+}
+
+UWorld* UUnitSignificanceSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UUnitSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UUnitSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+float UUnitSignificanceSubsystem::CalculateSignificance(const ABaseUnit* unit) const
+{
+	if (mViewLocations.Num() == 0)
+		return 1.0f;
+
+	FVector location = unit->GetActorLocation();
+	float closestDistSq = MAX_flt;
+	for (const FVector& view : mViewLocations)
+	{
+		closestDistSq = FMath::Min(closestDistSq, FVector::DistSquared(location, view));
+	}
+
+	// Falls off smoothly with distance, 0.5 at HalfSignificanceDistance
+	float significance = HalfSignificanceDistance / (HalfSignificanceDistance + FMath::Sqrt(closestDistSq));
+
+	// Anything coming for a local player is worth watching closely
+	AActor* target = unit->GetAITarget();
+	if (target && mLocalPlayers.Contains(target))
+		significance = FMath::Max(significance, 0.75f);
+
+	if (!unit->WasRecentlyRendered(0.1f))
+		significance *= OffscreenScale;
+
+	return significance;
+}
+
+void UUnitSignificanceSubsystem::SetupBudgetAllocator()
+{
+	IAnimationBudgetAllocator* allocator = IAnimationBudgetAllocator::Get(GetWorld());
+	if (!allocator)
+		return;
+
+	FAnimationBudgetAllocatorParameters parameters;
+	parameters.BudgetInMs = AnimationBudgetMs;
+
+	allocator->SetParameters(parameters);
+	allocator->SetEnabled(true);
+	mIsAllocatorSetUp = true;
+}
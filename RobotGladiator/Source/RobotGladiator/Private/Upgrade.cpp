@@ -2,6 +2,7 @@
 
 
 #include "Upgrade.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 // Sets default values
 AUpgrade::AUpgrade()
@@ -19,6 +20,12 @@ void AUpgrade::SetUpgradeStats(ERarities rarity, EUpgradeStatType stat, EWeaponT
 	AffectedWeapon = affectedWeapon;
 	StatIncrease = statIncrease;
 	StackIncrease = stackIncrease;
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(AUpgrade, Rarity, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AUpgrade, UpgradeStat, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AUpgrade, AffectedWeapon, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AUpgrade, StatIncrease, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AUpgrade, StackIncrease, this);
 }
 
 // Called when the game starts or when spawned
@@ -32,12 +39,16 @@ void AUpgrade::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetime
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(AUpgrade, UpgradeName);
-	DOREPLIFETIME(AUpgrade, Rarity);
-	DOREPLIFETIME(AUpgrade, AffectedWeapon);
-	DOREPLIFETIME(AUpgrade, UpgradeStat);
-	DOREPLIFETIME(AUpgrade, StatIncrease);
-	DOREPLIFETIME(AUpgrade, StackIncrease);
+	// Push model, on engines built with it stats are only compared after SetUpgradeStats or a blueprint changes them
+	FDoRepLifetimeParams params;
+	params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AUpgrade, UpgradeName, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AUpgrade, Rarity, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AUpgrade, AffectedWeapon, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AUpgrade, UpgradeStat, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AUpgrade, StatIncrease, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AUpgrade, StackIncrease, params);
 }
 
 // Called every frame
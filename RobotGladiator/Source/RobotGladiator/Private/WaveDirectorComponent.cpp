@@ -0,0 +1,150 @@
+/**
+ * @file WaveDirectorComponent.cpp
+ * @brief Defines the wave director, which feeds grunts into the arena over the course of a round
+ * @dependencies ActorComponent.h, ArenaGrid.h, TileOccupancy.h, HexFlowField.h, UnitPoolSubsystem.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#include "WaveDirectorComponent.h"
+#include "ArenaGrid.h"
+#include "BaseUnit.h"
+
+UWaveDirectorComponent::UWaveDirectorComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	WaveInterval = 15.0f;
+	GruntsPerWave = 4;
+	GruntsAddedPerWave = 1;
+	MaxAliveGrunts = 24;
+	MaxSpawnsPerFrame = 1;
+	MinPlayerSteps = 3;
+	MaxPlayerSteps = 8;
+	SpreadModifierGrunts = true;
+
+	mpArena = nullptr;
+	mWaveTimer = 0.0f;
+	mWaveNumber = 0;
+	mPendingSpawns = 0;
+	mIsRunning = false;
+
+	mRand.GenerateNewSeed();
+}
+
+void UWaveDirectorComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	mpArena = Cast<AArenaGrid>(GetOwner());
+}
+
+void UWaveDirectorComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Only the server spawns units
+	if (!mpArena || !mpArena->HasAuthority())
+		return;
+
+	PruneAlive();
+
+	if (mIsRunning)
+		UpdateWaves(DeltaTime);
+
+	if (mPendingSpawns > 0)
+		SpawnPending();
+}
+
+void UWaveDirectorComponent::StartWaves()
+{
+	mIsRunning = true;
+	mWaveNumber = 0;
+
+	// Send the first wave on the next tick
+	mWaveTimer = 0.0f;
+}
+
+void UWaveDirectorComponent::StopWaves()
+{
+	mIsRunning = false;
+}
+
+void UWaveDirectorComponent::Reset()
+{
+	mIsRunning = false;
+	mWaveNumber = 0;
+	mWaveTimer = 0.0f;
+	mPendingSpawns = 0;
+	mAlive.Reset();
+}
+
+void UWaveDirectorComponent::QueueSpawns(int count)
+{
+	mPendingSpawns += FMath::Max(count, 0);
+}
+
+void UWaveDirectorComponent::UpdateWaves(float deltaTime)
+{
+	mWaveTimer -= deltaTime;
+	if (mWaveTimer > 0.0f)
+		return;
+
+	mWaveTimer += WaveInterval;
+	QueueSpawns(GruntsPerWave + GruntsAddedPerWave * mWaveNumber);
+	mWaveNumber++;
+}
+
+void UWaveDirectorComponent::SpawnPending()
+{
+	int budget = FMath::Min3(MaxSpawnsPerFrame, mPendingSpawns, MaxAliveGrunts - mAlive.Num());
+	if (budget <= 0 || !mpArena->Grunt)
+		return;
+
+	GatherSpawnTiles();
+
+	// Nowhere to spawn right now (no players, or every good tile is taken), try again next frame
+	for (int i = 0; i < budget && mSpawnTiles.Num() > 0; i++)
+	{
+		int pick = mRand.RandHelper(mSpawnTiles.Num());
+		int tile = mSpawnTiles[pick];
+		mSpawnTiles.RemoveAtSwap(pick, 1, false);
+
+		ABaseUnit* grunt = Cast<ABaseUnit>(mpArena->SpawnGrunt(tile));
+		if (!grunt)
+			continue;
+
+		mAlive.Add(grunt);
+		mPendingSpawns--;
+	}
+}
+
+void UWaveDirectorComponent::GatherSpawnTiles()
+{
+	mSpawnTiles.Reset();
+
+	for (int tile = 0; tile < mpArena->FloorPieces.Num(); tile++)
+	{
+		// The flow field already knows how far the nearest player is and if they can be reached from here
+		int steps = mpArena->FlowField.GetDistance(tile);
+		if (steps == INDEX_NONE || steps < MinPlayerSteps || steps > MaxPlayerSteps)
+			continue;
+
+		if (mpArena->Occupancy.IsTileOccupied(tile) || mpArena->InfluenceMap.Sample(HAZARD, tile) > 0.0f)
+			continue;
+
+		mSpawnTiles.Add(tile);
+	}
+}
+
+void UWaveDirectorComponent::PruneAlive()
+{
+	for (int i = mAlive.Num() - 1; i >= 0; i--)
+	{
+		// Dead grunts are deactivated and wait in the pool rather than being destroyed
+		ABaseUnit* grunt = mAlive[i].Get();
+		if (!grunt || !grunt->mIsActive)
+			mAlive.RemoveAtSwap(i, 1, false);
+	}
+}
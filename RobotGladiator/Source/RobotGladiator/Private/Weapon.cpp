@@ -8,6 +8,7 @@
 
 #include "Weapon.h"
 #include "LootHUD.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 AWeapon::AWeapon()
 {
@@ -23,6 +24,10 @@ void AWeapon::SetWeaponStats(int baseDamage, ERarities rarity, EWeaponTypes type
 	BaseDamage = baseDamage;
 	Rarity = rarity;
 	WeaponType = type;
+
+	MARK_PROPERTY_DIRTY_FROM_NAME(AWeapon, BaseDamage, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AWeapon, Rarity, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(AWeapon, WeaponType, this);
 }
 
 void AWeapon::BeginPlay()
@@ -34,11 +39,15 @@ void AWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeP
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(AWeapon, BaseDamage);
-	DOREPLIFETIME(AWeapon, Rarity);
-	DOREPLIFETIME(AWeapon, WeaponType);
-	DOREPLIFETIME(AWeapon, WeaponName);
-	DOREPLIFETIME(AWeapon, Mesh);
+	// Push model, on engines built with it stats are only compared after SetWeaponStats or a blueprint changes them
+	FDoRepLifetimeParams params;
+	params.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AWeapon, BaseDamage, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AWeapon, Rarity, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AWeapon, WeaponType, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AWeapon, WeaponName, params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AWeapon, Mesh, params);
 }
 
 void AWeapon::Tick(float DeltaTime)
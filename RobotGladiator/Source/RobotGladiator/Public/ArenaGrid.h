@@ -1,7 +1,8 @@
 /**
  * @file ArenaGrid.h
  * @brief Declares the Arena Grid class which is responsible for generating and managing a hexagonal grid
- * @dependencies HexCell.h
+ * @dependencies HexCell.h, HexInfluenceMap.h, TileOccupancy.h, TileAreaEffects.h, HexFlowField.h, HexVisibility.h,
+ *		UnitPoolSubsystem.h, WaveDirectorComponent.h
  *
  * @author Ethan Heil
  * @author Henry Chronowski - State Saving/Editing
@@ -15,11 +16,18 @@
 #include "GameFramework/Actor.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "HexCell.h"
+#include "HexInfluenceMap.h"
+#include "TileOccupancy.h"
+#include "TileAreaEffects.h"
+#include "HexFlowField.h"
+#include "HexVisibility.h"
 #include "MyNavLinkProxy.h"
 #include "DrawDebugHelpers.h"
 #include "Math/UnrealMathUtility.h"
 #include "ArenaGrid.generated.h"
 
+class UWaveDirectorComponent;
+
 #define DEBUGMESSAGE(x, ...) if(GEngine){GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Yellow, FString::Printf(TEXT(x), __VA_ARGS__));}
 #define TIMEDDEBUGMESSAGE(x, y, ...) if(GEngine){GEngine->AddOnScreenDebugMessage(-1, x, FColor::Yellow, FString::Printf(TEXT(y), __VA_ARGS__));}
 
@@ -73,6 +81,8 @@ public:
 	}
 };
 
+class ABaseUnit;
+
 UCLASS()
 class ROBOTGLADIATOR_API AArenaGrid : public AActor
 {
@@ -81,6 +91,12 @@ class ROBOTGLADIATOR_API AArenaGrid : public AActor
 public:	
 	AArenaGrid();
 
+	/** @brief Finds the arena grid in a world
+	 *  @param {UObject*} worldContextObject - Any object in the world to search
+	 *  @return {AArenaGrid*} - The first arena grid found, or nullptr if there isn't one
+	 */
+	static AArenaGrid* FindArena(const UObject* worldContextObject);
+
 	UFUNCTION(BlueprintCallable)
 	/** @brief Spawns a hexagonal grid in the world at a given point
 	*  @param {FVector} origin - Origin point of the grid (aka the center of the grid)
@@ -157,6 +173,13 @@ public:
 	 */
 	FSaveState LoadSaveStateData(UPARAM(ref) int&index, float scale);
 
+	UFUNCTION(BlueprintCallable)
+	/** @brief Spawns a grunt standing on a tile, taken from the unit pool when possible
+	 *  @param {int} tile - The tile to spawn on
+	 *  @return {AActor*} - The grunt, or nullptr if the tile is invalid or Grunt isn't set
+	 */
+	AActor* SpawnGrunt(int tile);
+
 	UFUNCTION(BlueprintCallable)
 	/** @brief Spawns modifiers during gameplay
 	 *  @param {FSaveState} cur - The saved state to load modifier data from
@@ -168,6 +191,197 @@ public:
 	 */
 	void ClearTheBoard();
 
+	UFUNCTION(BlueprintCallable)
+	/** @brief Puts the floor pieces, toppers and nav links to sleep on the network. Their last state is sent
+	 *		first and they aren't considered for replication again until the arena is woken
+	 */
+	void SettleArena();
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Wakes the floor pieces, toppers and nav links in one batch so a layout change reaches clients.
+	 *		They settle again on their own AutoSettleDelay seconds after the last wake. The arena doesn't watch its
+	 *		actors for movement, so anything that moves them has to call this or SetTileHeight
+	 */
+	void WakeArena();
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Moves a floor piece to a new height and wakes the arena so the move reaches clients. Blueprints that
+	 *		animate tiles can call this every step, each call keeps the arena awake a little longer
+	 *  @param {int} tile - The index of the tile (into FloorPieces/FloorHeights)
+	 *  @param {float} height - The world height to move the floor piece to
+	 */
+	void SetTileHeight(int tile, float height);
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Whether the arena's actors are currently dormant
+	 */
+	bool IsArenaSettled() const { return mIsSettled; }
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Finds the tile underneath a world location
+	 *  @param {FVector} location - The world location to look up
+	 *  @return {int} - The index of the tile (into FloorPieces/FloorHeights), or -1 if the location is off the grid
+	 */
+	int GetTileAtLocation(FVector location) const;
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Gets the world location of the middle of a tile's walkable surface
+	 *  @param {int} tile - The index of the tile
+	 *  @return {FVector} - The center of the top of the tile, or the grid's location if the tile is invalid
+	 */
+	FVector GetTileCenter(int tile) const;
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Gets the world height of the walkable surface of a tile
+	 *  @param {int} tile - The index of the tile
+	 *  @return {float} - The height of the top of the tile
+	 */
+	float GetTileSurfaceHeight(int tile) const;
+
+	/** @brief Gets the distance between two tiles in rings
+	 *  @param {int} a - The index of the first tile
+	 *  @param {int} b - The index of the second tile
+	 *  @return {int} - The number of steps between the two tiles, or -1 if either tile is invalid
+	 */
+	int GetTileDistance(int a, int b) const;
+
+	/** @brief Gets how many rings around a tile have to be searched to find everything within a distance of a point on it
+	 *  @param {float} distance - The world distance to cover
+	 *  @return {int} - The number of rings to search
+	 */
+	int GetRingsForDistance(float distance) const;
+
+	/** @brief Gets the world origin of the spawned grid
+	 *  @return {FVector} - The origin BuildTileLookup was given
+	 */
+	FVector GetLayoutOrigin() const { return mLayoutOrigin; }
+
+	/** @brief Gets the world size of a tile in the spawned grid
+	 *  @return {float} - The distance from a tile's center to its corners
+	 */
+	float GetLayoutSize() const { return mLayoutSize; }
+
+	/** @brief Collects every tile within a number of rings of a tile, including the tile itself
+	 *  @param {int} tile - The index of the center tile
+	 *  @param {int} rings - How many rings out from the center to collect
+	 *  @param {TArray<int>&} outTiles - Filled with the indices of the tiles in range
+	 */
+	void GetTilesInRange(int tile, int rings, TArray<int>& outTiles) const;
+
+	/** @brief Calls a function for every tile within a number of rings of a tile, including the tile itself
+	 *  @param {int} tile - The index of the center tile
+	 *  @param {int} rings - How many rings out from the center to visit
+	 *  @param {Func} func - Called with the index of every tile in range
+	 */
+	template<typename Func>
+	void ForEachTileInRange(int tile, int rings, Func func) const
+	{
+		if (!mTileCoords.IsValidIndex(tile))
+			return;
+
+		// Walk every Axial coordinate within range. See https://www.redblobgames.com/grids/hexagons/ (Range section)
+		FIntPoint center = mTileCoords[tile];
+		for (int dq = -rings; dq <= rings; dq++)
+		{
+			int minR = FMath::Max(-rings, -dq - rings);
+			int maxR = FMath::Min(rings, -dq + rings);
+
+			for (int dr = minR; dr <= maxR; dr++)
+			{
+				int found = GetTileAtAxial(center.X + dq, center.Y + dr);
+				if (found != INDEX_NONE)
+					func(found);
+			}
+		}
+	}
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Checks if a straight line between two points is blocked by the arena floor.
+	 *		Walks the hex line between the two tiles instead of doing a physics trace
+	 *  @param {FVector} from - The world location the line starts at (i.e. the shooter's eyes)
+	 *  @param {FVector} to - The world location the line ends at
+	 *  @return {bool} - Returns true if no tile between the two points rises above the line
+	 */
+	bool HasLineOfSight(FVector from, FVector to) const;
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Checks line of sight from one point to many points at once
+	 *  @param {FVector} from - The world location the lines start at
+	 *  @param {TArray<FVector>} targets - The world locations to check against
+	 *  @param {TArray<bool>&} outVisible - Filled with one result per target, true if the target is visible
+	 */
+	void BatchLineOfSight(FVector from, const TArray<FVector>& targets, TArray<bool>& outVisible) const;
+
+	/** @brief Checks line of sight between two tiles against the stored floor heights
+	 *  @param {int} fromTile - The index of the tile the line starts on
+	 *  @param {float} fromHeight - The world height of the line at the start tile
+	 *  @param {int} toTile - The index of the tile the line ends on
+	 *  @param {float} toHeight - The world height of the line at the end tile
+	 *  @return {bool} - Returns true if no tile between the two rises above the line
+	 */
+	bool HasTileLineOfSight(int fromTile, float fromHeight, int toTile, float toHeight) const;
+
+	/** @brief Checks if a unit standing on one tile can see a unit standing on another, using the visibility table
+	 *  @param {int} fromTile - The index of the tile looking
+	 *  @param {int} toTile - The index of the tile being looked at
+	 *  @return {bool} - Returns true if the floor doesn't block the view
+	 */
+	bool CanTileSeeTile(int fromTile, int toTile) const { return Visibility.IsVisible(this, fromTile, toTile, VisibilityEyeHeight); }
+
+	/** @brief Gets which players can be seen from a tile, worked out at most once per tile per frame
+	 *  @param {int} tile - The index of the tile looking
+	 *  @return {uint32} - Bit i is set if the i-th player in the registry (up to 32) can be seen
+	 */
+	uint32 GetVisiblePlayerMask(int tile);
+
+	/** @brief Collects the players that can be seen from a tile
+	 *  @param {int} tile - The index of the tile looking
+	 *  @param {TArray<AActor*>&} outPlayers - Filled with the visible players
+	 */
+	void GetVisiblePlayers(int tile, TArray<AActor*>& outPlayers);
+
+	/** @brief Adds a unit to the occupancy index and stamps its influence
+	 *  @param {ABaseUnit*} unit - The unit to track
+	 */
+	void RegisterUnit(ABaseUnit* unit);
+
+	/** @brief Removes a unit from the occupancy index and takes its influence back out
+	 *  @param {ABaseUnit*} unit - The unit to stop tracking
+	 */
+	void UnregisterUnit(ABaseUnit* unit);
+
+	/** @brief Collects every unit standing within a number of rings of a tile
+	 *  @param {int} tile - The index of the center tile
+	 *  @param {int} rings - How many rings out from the center to collect, 0 for only the center tile
+	 *  @param {TArray<ABaseUnit*>&} outUnits - Filled with the units in range
+	 */
+	void GetUnitsInRange(int tile, int rings, TArray<ABaseUnit*>& outUnits) const;
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Collects every unit standing within a number of rings of the tile at a world location
+	 *  @param {FVector} location - The world location of the center tile
+	 *  @param {int} rings - How many rings out from the center to collect, 0 for only the center tile
+	 *  @param {TArray<ABaseUnit*>&} outUnits - Filled with the units in range
+	 */
+	void GetUnitsNearLocation(FVector location, int rings, TArray<ABaseUnit*>& outUnits) const;
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Adds a heal and/or damage effect to the tile at a world location, used by spills like toxic waste
+	 *  @param {FVector} location - The world location of the tile
+	 *  @param {float} healPerSecond - Health restored per second to every unit on the tile
+	 *  @param {float} damagePerSecond - Damage dealt per second to every unit on the tile
+	 *  @param {float} duration - How long the effect lasts in seconds, 0 or less lasts until the board is cleared
+	 */
+	void AddTileEffect(FVector location, float healPerSecond, float damagePerSecond, float duration);
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Samples the influence map at a world location
+	 *  @param {EInfluenceLayer} layer - The layer to sample
+	 *  @param {FVector} location - The world location to sample at
+	 *  @return {float} - The influence of the layer on the tile at the location
+	 */
+	float SampleInfluence(EInfluenceLayer layer, FVector location) const;
+
 public:
 	UPROPERTY(EditAnywhere,Category=Actors)
 	TSubclassOf<class AActor> FloorPieceActor;
@@ -195,6 +409,13 @@ public:
 
 	TArray<HexCell> Cells;
 	TArray<AMyNavLinkProxy*> NavLinks;
+	FHexInfluenceMap InfluenceMap;
+	FTileOccupancy Occupancy;
+	FTileAreaEffects TileEffects;
+	FHexFlowField FlowField;									// Leads towards the nearest player, rebuilt on the server every FlowFieldInterval
+	FHexVisibility Visibility;									// Which tiles can see each other, rebuilt on the server when the floor moves
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Waves)
+	UWaveDirectorComponent* WaveDirector;						// Spawns grunts over the course of a round
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
 	TArray<FSaveState> SavedStates;
 
@@ -209,6 +430,41 @@ public:
 	UPROPERTY(EditAnywhere, Category = ModifierChances)
 	float PercentGrunt;
 
+	UPROPERTY(EditAnywhere, Category = Influence)
+	int InfluenceSpreadRings;									// How many rings around a unit or hazard receive its influence
+	UPROPERTY(EditAnywhere, Category = Influence)
+	float InfluenceHalfLife;									// Seconds for influence to halve once its source has left
+	UPROPERTY(EditAnywhere, Category = Influence)
+	float PlayerThreatStrength;
+	UPROPERTY(EditAnywhere, Category = Influence)
+	float AllyStrength;
+	UPROPERTY(EditAnywhere, Category = Influence)
+	float ToxicHazardStrength;
+
+	UPROPERTY(EditAnywhere, Category = TileEffects)
+	bool UseNativeTileEffects;									// Heal and toxic toppers are applied by the grid instead of their effect volumes
+	UPROPERTY(EditAnywhere, Category = TileEffects)
+	bool TileEffectsAffectEnemies;
+	UPROPERTY(EditAnywhere, Category = TileEffects)
+	float TileEffectInterval;									// Seconds between each time tile effects are applied
+	UPROPERTY(EditAnywhere, Category = TileEffects)
+	FName HealTopperAmountProperty;								// Variable on the heal topper class with the health it gives each time it heals
+	UPROPERTY(EditAnywhere, Category = TileEffects)
+	FName ToxicTopperDamageProperty;							// Variable on the toxic topper class with the damage it deals each time it hurts
+	UPROPERTY(EditAnywhere, Category = TileEffects)
+	float TopperEffectPeriod;									// Seconds between each time a topper applies its amount, turns the amount into a rate
+
+	UPROPERTY(EditAnywhere, Category = FlowField)
+	float FlowFieldInterval;									// Seconds between rebuilds of the flow field
+
+	UPROPERTY(EditAnywhere, Category = Perception)
+	float VisibilityEyeHeight;									// Height above a tile's surface that units see from
+	UPROPERTY(EditAnywhere, Category = Perception)
+	int VisibilityPairsPerFrame;								// Tile pairs checked each frame while the visibility table is rebuilt
+
+	UPROPERTY(EditAnywhere, Category = Network)
+	float AutoSettleDelay;										// Seconds after the last WakeArena before the layout goes dormant, 0 or less keeps it awake
+
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	int Radius;
@@ -220,6 +476,8 @@ public:
 	float MaxHeight;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float JumpDifferenceThreshhold;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float TileSurfaceHeight;									// Distance from a tile's stored height to its walkable top
 
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
@@ -244,6 +502,88 @@ protected:
 	 */
 	void CalculateRing(HexCell center, int radius);
 
+	/** @brief Caches the layout of the spawned grid so tiles can be looked up by location and coordinate
+	 *  @param {FVector} origin - Origin point of the grid
+	 *  @param {int} radius - The radius of the grid
+	 *  @param {float} padding - The amount of padding between each cell in the grid
+	 */
+	void BuildTileLookup(FVector origin, int radius, float padding);
+
+	/** @brief Finds the tile at the given Axial coordinates
+	 *  @return {int} - The index of the tile, or -1 if the coordinates are off the grid
+	 */
+	int GetTileAtAxial(int q, int r) const;
+
+	/** @brief Moves every unit in the occupancy index that crossed into a new tile since the last update
+	 */
+	void UpdateUnitTiles();
+
+	/** @brief Gets the influence layer and strength a unit is stamped with
+	 *  @return {float} - The strength of the unit's influence
+	 */
+	float GetUnitInfluence(const ABaseUnit* unit, EInfluenceLayer& outLayer) const;
+
+	/** @brief Counts down timed tile effects and applies every tile effect to the units standing on them in one pass
+	 *  @param {float} deltaTime - Time elapsed since the last update
+	 */
+	void UpdateTileEffects(float deltaTime);
+
+	/** @brief Rebuilds the flow field towards the tiles the players are standing on
+	 */
+	void UpdateFlowField();
+
+	/** @brief Gathers the players and the tiles they are on for this frame's perception queries
+	 */
+	void UpdatePerceptionPlayers();
+
+	/** @brief Spawns an enemy, units are taken from the unit pool instead of being spawned when possible
+	 *  @param {TSubclassOf<AActor>} enemyClass - The class of enemy to spawn
+	 *  @param {FVector} location - Where to spawn the enemy
+	 *  @param {FRotator} rotation - Which way the enemy faces
+	 *  @param {FActorSpawnParameters} spawnParams - Used when a new actor has to be spawned
+	 *  @return {AActor*} - The enemy
+	 */
+	AActor* SpawnEnemy(TSubclassOf<AActor> enemyClass, FVector location, FRotator rotation, const FActorSpawnParameters& spawnParams);
+
+	/** @brief Works out the rate the grid applies a topper's effect at from the variables on the topper's class
+	 *  @param {TSubclassOf<AActor>} topperClass - The class of topper
+	 *  @param {FName} property - The float variable holding the amount the topper applies each time
+	 *  @return {float} - The amount per second, 0 if native tile effects are off or the variable can't be found
+	 */
+	float GetTopperRate(TSubclassOf<AActor> topperClass, FName property) const;
+
+	/** @brief Stops a topper's effect volume from generating overlap events, its meshes are left alone
+	 *  @param {AActor*} actor - The topper to silence
+	 */
+	void DisableEffectVolume(AActor* actor);
+
+	/** @brief Settles the layout once AutoSettleDelay has passed since it was last woken
+	 *  @param {float} deltaTime - Time elapsed since the last update
+	 */
+	void UpdateNetDormancy(float deltaTime);
+
+	/** @brief Calls a function on every valid floor piece, topper and nav link
+	 */
+	template<typename Func>
+	void ForEachLayoutActor(Func func) const
+	{
+		for (AActor* actor : FloorPieces)
+		{
+			if (IsValid(actor))
+				func(actor);
+		}
+		for (AActor* actor : Toppers)
+		{
+			if (IsValid(actor))
+				func(actor);
+		}
+		for (AMyNavLinkProxy* actor : NavLinks)
+		{
+			if (IsValid(actor))
+				func(actor);
+		}
+	}
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -254,4 +594,31 @@ private:
 	// A random stream to seed the perlin noise sample
 	FRandomStream mRand;
 
+	// Time until tile effects are next applied and the flow field is next rebuilt
+	float mTileEffectTimer;
+	float mFlowFieldTimer;
+
+	// Players and their tiles for this frame, in registry order so they line up with the visible player masks
+	UPROPERTY()
+	TArray<AActor*> mPerceptionPlayers;
+	TArray<int> mPerceptionPlayerTiles;
+
+	// Visible player mask of each tile and the frame it was worked out on
+	TArray<uint32> mTileVisibleMasks;
+	TArray<uint64> mTileVisibleFrames;
+
+	// Layout of the spawned grid, cached by BuildTileLookup
+	FVector mLayoutOrigin;
+	float mLayoutSize;
+	int mLayoutRadius;
+
+	// Tile index for every Axial coordinate in the grid's bounding rhombus (-1 where there is no tile)
+	TArray<int> mTileLookup;
+	// Axial coordinates of every tile, indexed the same as FloorPieces
+	TArray<FIntPoint> mTileCoords;
+
+	// Whether the layout is dormant and how long it has left to stay still before it is
+	bool mIsSettled;
+	float mSettleTimer;
+
 };
@@ -0,0 +1,184 @@
+/**
+ * @file ArenaReplicationGraph.h
+ * @brief Declares the replication graph for the arena, which only considers the actors near each player
+ * @dependencies ReplicationGraph.h, ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "ArenaReplicationGraph.generated.h"
+
+class AArenaGrid;
+
+// How an actor class is routed through the graph
+enum class EArenaRepPolicy : uint8
+{
+	NotRouted,					// Owner only actors, the per connection node picks these up
+	RelevantAllConnections,		// Game state, player states and the arena itself
+	ArenaStatic,				// Floor pieces, toppers and nav links, always relevant and dormant between layout changes
+	Spatialize_Static,			// Placed on a tile once, e.g. static actors that aren't part of the arena
+	Spatialize_Dynamic,			// Moved to the tile it is on every frame, e.g. units and loot
+};
+
+/**
+ * The actors on one arena tile. Gathering them also sets how often the connection replicates each of them, so
+ * tiles far from a player can be replicated less often than their class asks for
+ */
+UCLASS()
+class ROBOTGLADIATOR_API UReplicationGraphNode_HexTile : public UReplicationGraphNode_ActorList
+{
+	GENERATED_BODY()
+
+public:
+	/** @brief Gathers the tile's actors for a connection and sets their replication period on it
+	 *  @param {FConnectionGatherActorListParameters} params - The connection being gathered for
+	 *  @param {int} periodScale - How many times longer than their class period the actors wait between updates
+	 */
+	void GatherActorListsAtRate(const FConnectionGatherActorListParameters& params, int periodScale);
+};
+
+/**
+ * Buckets actors by the arena tile they are on. Each connection only gathers the tiles within a number of rings of
+ * its viewers, so the cost of a connection grows with the actors near it rather than every actor
+ */
+UCLASS()
+class ROBOTGLADIATOR_API UReplicationGraphNode_HexGrid : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+	UReplicationGraphNode_HexGrid();
+
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound = true) override;
+	virtual void NotifyResetAllNetworkActors() override;
+	virtual void PrepareForReplication() override;
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+	/** @brief Adds an actor that is bucketed once and never moves tile
+	 *  @param {FNewReplicatedActorInfo} actorInfo - The actor
+	 */
+	void AddActor_Static(const FNewReplicatedActorInfo& actorInfo) { AddActor(actorInfo, false); }
+
+	/** @brief Adds an actor that is moved to the tile it is on every frame
+	 *  @param {FNewReplicatedActorInfo} actorInfo - The actor
+	 */
+	void AddActor_Dynamic(const FNewReplicatedActorInfo& actorInfo) { AddActor(actorInfo, true); }
+
+public:
+	// Distance from a viewer that tiles are gathered within, per class cull distances still apply on top
+	float CullDistance;
+
+	// Distance from a viewer that actors replicate at their class rate within, 0 turns the falloff off
+	float FullRateDistance;
+
+	// Most times slower than their class rate that far actors replicate
+	int MaxPeriodScale;
+
+private:
+	void AddActor(const FNewReplicatedActorInfo& actorInfo, bool isDynamic);
+
+	// Puts an actor in the node of the tile it is on, or the off grid node
+	void PlaceActor(int index, int tile);
+
+	// Looks for the arena and rebuckets everything if it or its layout changed
+	void UpdateArena();
+
+	// How many times slower than their class rate the actors a number of rings from a viewer replicate
+	int GetPeriodScale(int rings) const;
+
+	UReplicationGraphNode_ActorList* GetTileNode(int tile) const { return tile == INDEX_NONE ? mpOffGridNode : mTileNodes[tile]; }
+
+private:
+	TWeakObjectPtr<AArenaGrid> mpArena;
+	int mNumTiles;
+	int mCullRings;
+	int mFullRateRings;
+
+	// Layout the actors were bucketed for, the same tile index is somewhere else once it changes
+	FVector mLayoutOrigin;
+	float mLayoutSize;
+
+	// One child node per tile, there can be more than the arena has tiles after it shrinks
+	UPROPERTY()
+	TArray<UReplicationGraphNode_HexTile*> mTileNodes;
+
+	// Actors that aren't over any tile, gathered for every connection
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* mpOffGridNode;
+
+	// Every actor in the node and the tile it is bucketed on
+	TArray<AActor*> mActors;
+	TArray<int> mActorTiles;
+	TArray<bool> mActorIsDynamic;
+
+	// Tiles gathered for the connection being replicated and how many rings they are from its nearest viewer
+	TArray<int> mGatherTiles;
+	TArray<int> mGatherRings;
+};
+
+/**
+ * Routes every replicated actor to one of a few nodes by its class and owner: units and loot go in the hex grid
+ * node, the arena's floor, toppers and nav links in an always relevant list that sits dormant between layout
+ * changes, and game wide actors in an always relevant list. Loot gets its own cull distance and update rate, and
+ * units and loot far from a player replicate to them less often. Set as the replication driver of the net drivers
+ * in DefaultEngine.ini
+ */
+UCLASS(config = Game)
+class ROBOTGLADIATOR_API UArenaReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	UArenaReplicationGraph();
+
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+
+public:
+	// Distance from a player that units and loot are gathered within
+	UPROPERTY(config)
+	float SpatialCullDistance;
+
+	// Distance from a player that loot is replicated within
+	UPROPERTY(config)
+	float LootCullDistance;
+
+	// Times per second loot is considered for replication, it almost never changes
+	UPROPERTY(config)
+	float LootUpdateFrequency;
+
+	// Distance from a player that units and loot replicate at their full rate within, further out the rate falls
+	// off with distance. 0 turns the falloff off
+	UPROPERTY(config)
+	float FullRateDistance;
+
+	// Most times slower than their full rate that far units and loot replicate
+	UPROPERTY(config)
+	int MaxPeriodScale;
+
+private:
+	// Decides how an actor is routed
+	EArenaRepPolicy GetPolicy(const AActor* actor) const;
+
+	// Fills in the update rate and cull distance of a class from its defaults
+	void SetClassInfo(UClass* actorClass, float netUpdateFrequency, float cullDistance);
+
+private:
+	UPROPERTY()
+	UReplicationGraphNode_HexGrid* mpHexGridNode;
+
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* mpAlwaysRelevantNode;
+
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* mpArenaNode;
+};
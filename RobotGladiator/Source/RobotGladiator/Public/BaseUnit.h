@@ -14,8 +14,14 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Net/UnrealNetwork.h"
+#include "HexInfluenceMap.h"
+#include "UnitAIManager.h"
+#include "StatusEffectSubsystem.h"
+#include "QuantizedHealth.h"
 #include "BaseUnit.generated.h"
 
+class AArenaGrid;
+
 UCLASS()
 class ROBOTGLADIATOR_API ABaseUnit : public ACharacter
 {
@@ -23,34 +29,112 @@ class ROBOTGLADIATOR_API ABaseUnit : public ACharacter
 
 public:
 	// Sets default values for this pawn's properties
-	ABaseUnit();
+	ABaseUnit(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Replicated)
+	// Replicated through mReplicatedHealth, so on clients it is only accurate to a fraction of mMaxHealth
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 		float mHealth;
 
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Replicated)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, ReplicatedUsing = OnRep_Health)
 		float mMaxHealth;
 
+	// mHealth packed as a fraction of mMaxHealth, updated just before the unit replicates
+	UPROPERTY(ReplicatedUsing = OnRep_Health)
+		FQuantizedHealth mReplicatedHealth;
+
+	// Players threaten the gladiator's side, every other unit is on it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		bool mIsPlayerUnit;
+
+	// The arena tile this unit is standing on, kept up to date by the arena
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+		int mCurrentTile;
+
+	// Handle of this unit in the arena's occupancy index
+	int mOccupancyHandle;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+		AArenaGrid* mpArena;
+
+	// The AI manager makes this unit's decisions. Off by default, blueprints that choose targets and attack from
+	// their own behaviour tree or Event Tick leave it off so they aren't driven twice
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AI)
+		bool mUseNativeAI;
+
+	// Handle of this unit in the AI manager
+	int mAIHandle;
+
+	// Handle of this unit in the crowd avoidance subsystem
+	int mAvoidanceHandle;
+
+	// Handle of this unit in the status effect subsystem, INDEX_NONE until an effect is put on it
+	int mStatusHandle;
+
+	// Handle of this unit in the lag compensation position history, server only
+	int mHistoryHandle;
+
+	// How much thinking the AI manager is doing for this unit, based on how close it is to a player
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = AI)
+		TEnumAsByte<EAILODTier> mAILODTier;
+
+	// Walk speed multiplier from status effects, replicated so owning clients predict the same speed
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Replicated)
+		float mSpeedScale;
+
+	// False while the unit is dead and waiting in the unit pool
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_IsActive)
+		bool mIsActive;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the unit is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const;
 
+	// Adds the unit to the arena, player registry and AI manager
+	void RegisterWithSystems();
+
+	// Removes the unit from everything RegisterWithSystems added it to
+	void UnregisterFromSystems();
+
+	// Shows or hides the unit and turns its collision and ticking on or off to match mIsActive
+	void ApplyActiveState();
+
+	UFUNCTION()
+	void OnRep_IsActive();
+
+	// Unpacks the replicated health on clients
+	UFUNCTION()
+	void OnRep_Health();
+
+	// mMaxHealth as of the last net update, to tell when it needs marking dirty
+	float mSentMaxHealth;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	// Packs mHealth into mReplicatedHealth and marks it or mMaxHealth dirty only if they changed
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
+	/**   @brief Sets the multiplier status effects put on the unit's walk speed
+	 *    @param {float} scale - the multiplier, 1 for normal speed
+	 */
+	void SetSpeedScale(float scale);
+
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* 
 		PlayerInputComponent) override;
 
 	UFUNCTION(BlueprintCallable)
-	/**   @brief Take damage and decrement mHealth
+	/**   @brief Take damage and decrement mHealth right away, DealDamage should be used for attacks
 	*    @param {float} damage - damage to be taken
-	*    @return {bool} Returns true if unit was destroyed
+	*    @return {bool} Returns true if unit was killed, always false off the server
 	*/
 	bool TakeDamage_Unit(float damage);
 
@@ -71,16 +155,144 @@ public:
 	void HealUnit(ABaseUnit* oposingUnit, float healAmount);
 
 	UFUNCTION(BlueprintCallable)
-	/**   @brief <Deal damage to an oposing unit>
+	/**   @brief Puts a status effect on an oposing unit, the effect is run by the status effect subsystem
+	*	  @param {ABaseUnit*} oposingUnit - unit to affect
+	*    @param {FStatusEffectSpec} effect - the effect and how it stacks
+	*    @return {bool} - true if the effect was applied
+	*/
+	bool ApplyStatusEffect(ABaseUnit* oposingUnit, const FStatusEffectSpec& effect);
+
+	UFUNCTION(BlueprintCallable)
+	/**   @brief <Deal damage to an oposing unit, the damage is queued and applied at the end of the frame>
 	*	  @param {ABaseUnit*} oposingUnit - <unit to take damage>
 	*    @param {<float>} damage - damage>
-	*    @return {<bool>} - <Returns true if the oposing unit was destroyed>
+	*    @return {<bool>} - <Returns true if this hit will kill the oposing unit>
 	*/
 	bool DealDamage(ABaseUnit* oposingUnit, float damage);
 
-	/**   @brief Get the closes player to the gladiator
+	UFUNCTION(BlueprintCallable)
+	/**   @brief Swings at everything in an arc in front of this unit, resolved by the melee resolver at the end of the frame
+	*    @param {float} angle - width of the arc in degrees
+	*    @param {float} range - how far the swing reaches
+	*    @param {float} damage - damage dealt to every unit hit
+	*/
+	void MeleeSwing(float angle, float range, float damage);
+
+	UFUNCTION(BlueprintImplementableEvent)
+	/**   @brief Called when one of this unit's melee swings hits, for hit effects
+	*    @param {ABaseUnit*} target - the unit that was hit
+	*/
+	void OnMeleeHit(ABaseUnit* target);
+
+	/**   @brief Called once health reaches zero, at a point where nothing is iterating over units.
+	*		Enemies are returned to the unit pool, players are destroyed. Only runs on the server
+	*/
+	virtual void Die();
+
+	UFUNCTION(BlueprintImplementableEvent)
+	/**   @brief Called when the unit dies, before it is pooled or destroyed. Death effects and drops go here
+	*/
+	void OnDeath();
+
+	UFUNCTION(BlueprintImplementableEvent)
+	/**   @brief Called when a pooled unit is put back into play, after its C++ state is reset. BeginPlay doesn't run
+	*		again, so anything the blueprint keeps (attack flags, blackboard targets, timers) should be reset here
+	*/
+	void OnUnitReused();
+
+	/**   @brief Puts a pooled unit back into play with fresh health and state
+	*/
+	void ActivateUnit();
+
+	/**   @brief Takes the unit out of play so it can wait in the unit pool
+	*/
+	void DeactivateUnit();
+
+	/**   @brief Restores the unit's health and combat state to its class defaults, called when a pooled unit is reused.
+	*		Subclasses reset their own state and call Super
+	*/
+	virtual void ResetUnit();
+
+	/**   @brief Get the closest actor in an array to this unit. Blueprints call the grunt's exec node of the same name
 	 *	  @param {TArray<AActor*>} Array - array of actors to choose from -
-	 *    @return {AActor*} - the closest player to the gladiator
+	 *    @return {AActor*} - the closest actor to this unit
+	 */
+	AActor* GetClosestPlayer(const TArray<AActor*>& Array) const;
+
+	UFUNCTION(BlueprintCallable)
+	/**   @brief Get the closest registered player to this unit without searching the world
+	 *	  @param {TSubclassOf<AActor>} classFilter - only players of this class are considered, none for any player
+	 *    @return {AActor*} - the closest player to this unit, nullptr if there are none
 	 */
-	AActor* GetClosestPlayer(TArray<AActor*> Array);
+	AActor* FindClosestPlayer(TSubclassOf<AActor> classFilter = nullptr) const;
+
+	UFUNCTION(BlueprintCallable)
+	/**   @brief Sample the arena's influence map at the tile this unit is standing on
+	*    @param {EInfluenceLayer} layer - the influence layer to sample
+	*    @return {float} - the influence on this unit's tile, 0 if there is no arena
+	*/
+	float SampleInfluence(EInfluenceLayer layer) const;
+
+	UFUNCTION(BlueprintCallable)
+	/**   @brief Get the players this unit can see, from the arena's tile visibility table instead of sight traces
+	*    @return {TArray<AActor*>} - the visible players, empty if there is no arena or this isn't the server
+	*/
+	TArray<AActor*> GetVisiblePlayers() const;
+
+	UFUNCTION(BlueprintCallable)
+	/**   @brief Check if this unit can see an actor, using the arena's tile visibility table
+	*    @param {AActor*} other - the actor to look for
+	*    @return {bool} - true if the floor doesn't block the view
+	*/
+	bool CanSeeActor(const AActor* other) const;
+
+	/**   @brief Called by the AI manager with the latest state it has for this unit
+	*    @param {AActor*} target - the unit's current target, nullptr if it has none
+	*    @param {float} distance - distance to the target
+	*    @param {float} cooldown - time left before the unit can act again
+	*/
+	virtual void ReceiveAIState(AActor* target, float distance, float cooldown) {}
+
+	/**   @brief Called by the AI manager to check if the unit is in the middle of an action
+	*    @return {bool} - true if the unit shouldn't be given a new action yet
+	*/
+	virtual bool IsAIBusy() const { return false; }
+
+	/**   @brief Called by the AI manager when the unit has a target and is off cooldown
+	*    @param {float} distance - distance to the target
+	*    @return {float} - cooldown before the unit acts again, negative if it did nothing
+	*/
+	virtual float PerformAIAction(float distance) { return -1.0f; }
+
+	/**   @brief Cooldown before the unit's first action once the AI manager takes over
+	*    @return {float} - time in seconds
+	*/
+	virtual float GetAIStartCooldown() const { return 0.0f; }
+
+	/**   @brief Class of actor the AI manager should target for this unit
+	*    @return {TSubclassOf<AActor>} - the class to target, none for any player
+	*/
+	virtual TSubclassOf<AActor> GetAITargetClass() const { return nullptr; }
+
+	/**   @brief Called by the AI manager when it looks for a new target for this unit
+	*    @return {AActor*} - the target this unit wants, nullptr to let the AI manager pick the closest player
+	*/
+	virtual AActor* ChooseAITarget() { return nullptr; }
+
+	/**   @brief Called when another unit's hit on this unit is queued, before the damage is applied
+	*    @param {ABaseUnit*} instigator - the unit that dealt the damage
+	*    @param {float} damage - the damage dealt
+	*/
+	virtual void ReceiveDamageFrom(ABaseUnit* instigator, float damage) {}
+
+	/**   @brief The actor this unit is currently after, used to decide how closely to animate it
+	*    @return {AActor*} - the unit's target, nullptr if it has none or it isn't known on this machine
+	*/
+	virtual AActor* GetAITarget() const { return nullptr; }
+
+	/**   @brief Called by the AI manager when the unit moves to a different LOD tier
+	*    @param {EAILODTier} tier - the unit's new tier
+	*    @param {float} movementTickInterval - how often the movement component should tick, 0 for every frame
+	*/
+	virtual void SetAILOD(EAILODTier tier, float movementTickInterval);
 };
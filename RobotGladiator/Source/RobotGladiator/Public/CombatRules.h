@@ -0,0 +1,68 @@
+/**
+ * @file CombatRules.h
+ * @brief Declares the combat rules shared by the gameplay units and the headless combat simulation
+ * @dependencies None
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * The rules are templates so the units can run them on floats and the simulation on fixed point integers.
+ * Anything that changes how damage, healing or effect stacking works should change here so both stay the same
+ */
+namespace CombatRules
+{
+	/** @brief Takes damage off a unit's health
+	 *  @param {T&} health - The unit's health
+	 *  @param {T} damage - Damage to take
+	 *  @return {bool} - true if this damage killed the unit, false if it survived or was already dead
+	 */
+	template <typename T>
+	FORCEINLINE bool ApplyDamage(T& health, T damage)
+	{
+		if (health <= 0)
+			return false;
+
+		health -= damage;
+		return health <= 0;
+	}
+
+	/** @brief Restores a unit's health, up to its max health
+	 *  @param {T&} health - The unit's health
+	 *  @param {T} maxHealth - The unit's max health
+	 *  @param {T} amount - Health to restore
+	 */
+	template <typename T>
+	FORCEINLINE void ApplyHeal(T& health, T maxHealth, T amount)
+	{
+		health = FMath::Min(health + amount, maxHealth);
+	}
+
+	/** @brief Adds a stack to an effect that stacks in intensity
+	 *  @param {int} stacks - The effect's stacks
+	 *  @param {int} maxStacks - Most stacks the effect can have
+	 *  @return {int} - The effect's new stacks
+	 */
+	FORCEINLINE int AddStack(int stacks, int maxStacks)
+	{
+		return FMath::Min(stacks + 1, FMath::Max(maxStacks, 1));
+	}
+
+	/** @brief Keeps whichever value of a reapplied effect is further from doing nothing, so a weak reapplication
+	 *		doesn't cut short a strong one
+	 *  @param {T&} current - The value on the running effect
+	 *  @param {T} incoming - The value being applied
+	 *  @param {T} neutral - The value that does nothing, 0 for rates and 1 for multipliers
+	 */
+	template <typename T>
+	FORCEINLINE void KeepStronger(T& current, T incoming, T neutral)
+	{
+		if (FMath::Abs(incoming - neutral) >= FMath::Abs(current - neutral))
+			current = incoming;
+	}
+}
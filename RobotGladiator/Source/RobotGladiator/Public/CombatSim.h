@@ -0,0 +1,166 @@
+/**
+ * @file CombatSim.h
+ * @brief Declares a headless, deterministic combat simulation for balance testing without a world or actors
+ * @dependencies CombatRules.h, StatusEffectSubsystem.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StatusEffectSubsystem.h"
+
+/** @brief The stats a simulated unit starts with, in the same units the gameplay code uses
+ */
+struct ROBOTGLADIATOR_API FSimUnitDef
+{
+	int Team;
+	float MaxHealth;
+	float Damage;				// Per attack
+	float AttackInterval;		// Seconds between attacks
+	float Range;				// How far an attack reaches
+	float Speed;				// Walk speed
+	float CritChance;			// Chance an attack does double damage, 0 to 1
+	FStatusEffectSpec OnHitEffect;	// Put on every unit hit, no effect if its EffectId is None
+
+	FSimUnitDef()
+		: Team(0), MaxHealth(100.0f), Damage(10.0f), AttackInterval(1.0f), Range(150.0f), Speed(400.0f), CritChance(0.0f){}
+};
+
+/** @brief How a simulated round ended
+ */
+struct FCombatSimResult
+{
+	int WinningTeam;			// INDEX_NONE if the round ran out of time
+	int Ticks;
+	int NumAlive;
+	uint32 Checksum;			// Changes if any unit's health or position differs on any tick
+
+	FCombatSimResult()
+		: WinningTeam(INDEX_NONE), Ticks(0), NumAlive(0), Checksum(0){}
+};
+
+/**
+ * Units, attacks, cooldowns and status effects stepped at a fixed rate with nothing but integers: health and
+ * positions are stored in thousandths, durations and cooldowns in ticks, and randomness comes from a seeded
+ * stream. Floats are only converted once when a unit is added, so the same seed and units give the same round
+ * bit for bit on any machine. Damage, healing and stacking go through CombatRules, the same functions the
+ * gameplay units use. Units are packed arrays indexed by the order they were added, and are never removed
+ */
+class ROBOTGLADIATOR_API FCombatSim
+{
+public:
+	// Fixed point scale, 1.0 is stored as FixedOne
+	static const int32 FixedOne = 1000;
+
+	/** @brief Creates an empty simulation
+	 *  @param {int} tickRate - Steps per second
+	 */
+	FCombatSim(int tickRate = 30);
+
+	/** @brief Removes every unit and reseeds the random stream
+	 *  @param {int} seed - Seed for everything random in the round
+	 */
+	void Reset(int seed);
+
+	/** @brief Adds a unit
+	 *  @param {FSimUnitDef} def - The unit's stats
+	 *  @param {FVector2D} location - Where the unit starts
+	 *  @return {int} - The unit's index
+	 */
+	int AddUnit(const FSimUnitDef& def, FVector2D location);
+
+	/** @brief Adds units scattered around a point, placed by the random stream
+	 *  @param {FSimUnitDef} def - The units' stats
+	 *  @param {int} count - Units to add
+	 *  @param {FVector2D} center - Middle of the group
+	 *  @param {float} radius - Half the width of the square the units are scattered over
+	 */
+	void AddGroup(const FSimUnitDef& def, int count, FVector2D center, float radius);
+
+	// Advances the simulation by one tick
+	void Step();
+
+	/** @brief Steps until one team is left or the time runs out
+	 *  @param {int} maxTicks - Most ticks to run
+	 *  @return {FCombatSimResult} - How the round ended
+	 */
+	FCombatSimResult RunRound(int maxTicks);
+
+	// Returns the team that has units left if only one does, otherwise INDEX_NONE
+	int GetWinningTeam() const;
+
+	int GetNumUnits() const { return mTeams.Num(); }
+	int GetNumAlive() const { return mNumAlive; }
+	int GetTick() const { return mTick; }
+	uint32 GetChecksum() const { return mChecksum; }
+	float GetHealth(int unit) const { return (float)mHealth[unit] / FixedOne; }
+
+private:
+	// Adds a unit at a fixed point location
+	int AddUnitAt(const FSimUnitDef& def, int32 x, int32 y);
+
+	// Finds the closest living enemy, ties go to the lower index
+	int FindTarget(int unit) const;
+
+	// An on hit effect converted to fixed point
+	struct FSimEffect
+	{
+		FName Id;
+		int32 RatePerTick;
+		int32 SpeedMultiplier;
+		int Ticks;					// Negative lasts until the round ends
+		EStatusStacking Stacking;
+		int MaxStacks;
+	};
+
+	// Puts an on hit effect on a unit, stacking the way the status effect subsystem does
+	void ApplyEffect(int unit, const FSimEffect& effect);
+
+	// Adds up every effect's health change and speed for the tick and counts down their durations
+	void StepEffects();
+
+	static int32 ToFixed(float value) { return FMath::RoundToInt(value * FixedOne); }
+
+	// Floor of the square root, exact for every input
+	static int64 SquareRoot(int64 value);
+
+private:
+	int mTickRate;
+	int mTick;
+	int mNumAlive;
+	uint32 mChecksum;
+	FRandomStream mRand;
+
+	// Per unit, fixed point unless noted
+	TArray<int> mTeams;
+	TArray<int32> mHealth;
+	TArray<int32> mMaxHealth;
+	TArray<int32> mDamage;
+	TArray<int> mAttackTicks;		// Ticks
+	TArray<int> mCooldowns;			// Ticks
+	TArray<int32> mRange;
+	TArray<int32> mSpeed;			// Per tick
+	TArray<uint32> mCritChance;		// Out of FixedOne
+	TArray<int32> mX;
+	TArray<int32> mY;
+	TArray<int> mOnHitEffects;		// Index into mEffectDefs, INDEX_NONE for none
+
+	// Worked out every tick
+	TArray<int32> mHealthDeltas;	// From effects
+	TArray<int32> mSpeedScales;
+	TArray<int32> mPendingDamage;	// From attacks, applied once every unit has acted
+
+	// Per running effect
+	TArray<int> mEffectUnits;
+	TArray<FName> mEffectIds;
+	TArray<int32> mEffectRates;		// Health per tick per stack
+	TArray<int32> mEffectSpeeds;
+	TArray<int> mEffectStacks;
+	TArray<int> mEffectTicksLeft;	// Negative lasts forever
+
+	// On hit effects the units were added with
+	TArray<FSimEffect> mEffectDefs;
+};
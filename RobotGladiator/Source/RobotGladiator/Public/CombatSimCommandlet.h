@@ -0,0 +1,31 @@
+/**
+ * @file CombatSimCommandlet.h
+ * @brief Declares a commandlet that batch runs headless combat rounds for balance and soak testing
+ * @dependencies Commandlet.h, CombatSim.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CombatSimCommandlet.generated.h"
+
+/**
+ * Runs rounds of players against grunts and gladiators in FCombatSim, one seed per round, and prints who won, how
+ * long rounds took and how many rounds ran per second. The first round is run twice and the commandlet fails if the
+ * two don't match, so CI catches anything that breaks determinism.
+ * Usage: UE4Editor-Cmd RobotGladiator -run=CombatSim [-rounds=1000] [-seed=1] [-players=4] [-grunts=24] [-gladiators=1] [-seconds=180]
+ */
+UCLASS()
+class ROBOTGLADIATOR_API UCombatSimCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCombatSimCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,104 @@
+/**
+ * @file CrowdAvoidanceSubsystem.h
+ * @brief Declares a world subsystem that steers crowds of grunts around each other in one parallel pass
+ * @dependencies WorldSubsystem.h, Tickable.h, ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "CrowdAvoidanceSubsystem.generated.h"
+
+class ABaseUnit;
+class AArenaGrid;
+
+/**
+ * Agents register their unit, and once per frame their positions and velocities are copied into packed arrays.
+ * Every agent then looks at the units on its own and neighbouring tiles through the arena occupancy index, predicts
+ * the closest approach to each of them within a time horizon and steers away from the ones it would run into. The
+ * steering is worked out for every agent at once across worker threads and applied by the agent's movement
+ * component on its next move, so grunts spread around a target instead of shoving each other's capsules
+ */
+UCLASS(config = Game)
+class ROBOTGLADIATOR_API UCrowdAvoidanceSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UCrowdAvoidanceSubsystem();
+
+	/** @brief Gets the crowd avoidance subsystem for the world an object is in
+	 *  @param {UObject*} worldContextObject - Any object in the world
+	 *  @return {UCrowdAvoidanceSubsystem*} - The subsystem, or nullptr if the object isn't in a world
+	 */
+	static UCrowdAvoidanceSubsystem* Get(const UObject* worldContextObject);
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	/** @brief Starts steering a unit around the crowd
+	 *  @param {ABaseUnit*} unit - The unit to steer
+	 */
+	void RegisterAgent(ABaseUnit* unit);
+
+	/** @brief Stops steering a unit
+	 *  @param {ABaseUnit*} unit - The unit to stop steering
+	 */
+	void UnregisterAgent(ABaseUnit* unit);
+
+	/** @brief Gets the change in velocity that keeps an agent clear of its neighbours
+	 *  @param {int} handle - The agent's handle
+	 *  @return {FVector} - Velocity to add to the agent's own, zero if it has nothing to avoid
+	 */
+	FVector GetAvoidance(int handle) const { return mAvoidance.IsValidIndex(handle) ? mAvoidance[handle] : FVector::ZeroVector; }
+
+public:
+	// How far ahead in seconds agents look for collisions
+	UPROPERTY(config)
+	float TimeHorizon;
+
+	// Extra space agents try to keep between their capsules
+	UPROPERTY(config)
+	float Separation;
+
+	// Scales how hard agents steer away from each other
+	UPROPERTY(config)
+	float AvoidanceStrength;
+
+	// Below this many agents the pass runs on the game thread only
+	int ParallelThreshold;
+
+private:
+	// Copies the position, velocity and size of every agent into the packed arrays
+	void GatherAgents();
+
+	// Works out the avoidance of every agent
+	void ComputeAvoidance();
+
+	// Works out the avoidance of one agent from the units around it
+	FVector ComputeAgentAvoidance(int agent) const;
+
+private:
+	// Per agent state, all indexed by the agent's handle
+	UPROPERTY()
+	TArray<ABaseUnit*> mAgents;
+	TArray<FVector> mPositions;
+	TArray<FVector> mVelocities;
+	TArray<float> mRadii;
+	TArray<int> mTiles;
+	TArray<FVector> mAvoidance;
+
+	UPROPERTY()
+	AArenaGrid* mpArena;
+};
@@ -0,0 +1,78 @@
+/**
+ * @file DamageQueueSubsystem.h
+ * @brief Declares a world subsystem that collects the hits dealt during a frame and applies them all at once
+ * @dependencies WorldSubsystem.h, Tickable.h, BaseUnit.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "DamageQueueSubsystem.generated.h"
+
+class ABaseUnit;
+
+/**
+ * Hits are added up per target as they come in and resolved once at the end of the frame, so a unit caught by
+ * several attacks only has its health changed (and replicated) once. Targets are resolved in the order they were
+ * first hit, and units that die are only removed after every target has had its damage applied
+ */
+UCLASS()
+class ROBOTGLADIATOR_API UDamageQueueSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UDamageQueueSubsystem();
+
+	/** @brief Gets the damage queue for the world an object is in
+	 *  @param {UObject*} worldContextObject - Any object in the world
+	 *  @return {UDamageQueueSubsystem*} - The damage queue, or nullptr if the object isn't in a world
+	 */
+	static UDamageQueueSubsystem* Get(const UObject* worldContextObject);
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Queues damage against a unit, it is applied at the end of the frame
+	 *  @param {ABaseUnit*} target - The unit to damage
+	 *  @param {float} damage - The amount of damage
+	 *  @param {ABaseUnit*} instigator - The unit that dealt the damage, told to the target straight away. Can be nullptr
+	 *  @return {bool} - true if this hit is the one that will kill the unit, always false off the server
+	 */
+	bool QueueDamage(ABaseUnit* target, float damage, ABaseUnit* instigator = nullptr);
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Gets the damage waiting to be applied to a unit this frame
+	 *  @param {ABaseUnit*} target - The unit to check
+	 *  @return {float} - The queued damage, 0 if the unit hasn't been hit
+	 */
+	float GetPendingDamage(const ABaseUnit* target) const;
+
+	// Applies every queued hit and kills the units that ran out of health
+	void ResolveDamage();
+
+private:
+	// Units hit this frame in the order they were first hit, with the total damage dealt to each
+	UPROPERTY()
+	TArray<ABaseUnit*> mTargets;
+	TArray<float> mDamage;
+
+	// Index of each target in mTargets
+	TMap<const ABaseUnit*, int> mTargetIndices;
+
+	// Units killed by the current resolve, kept between frames to avoid reallocating
+	UPROPERTY()
+	TArray<ABaseUnit*> mKilled;
+};
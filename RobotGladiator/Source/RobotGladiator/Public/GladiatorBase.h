@@ -13,6 +13,7 @@
 
 #include "CoreMinimal.h"
 #include "BaseUnit.h"
+#include "ThreatTable.h"
 #include "GladiatorBase.generated.h"
 
 /**
@@ -29,13 +30,6 @@ class ROBOTGLADIATOR_API AGladiatorBase : public ABaseUnit
 	GENERATED_BODY()
 
 
-	/** @brief Get the closes player to the gladiator
-	*	@param {TArray<AActor*>} Array - array of actors to choose from -
-	*   @return {AActor*} - the closest player to the gladiator
-	*/
-	AActor* GetClosestPlayer(TArray<AActor*> Array);
-
-
 protected:
 
 	virtual void BeginPlay() override;
@@ -45,6 +39,33 @@ protected:
 public:
 
 	AGladiatorBase();
+
+	// AI manager interface
+	virtual void ReceiveAIState(AActor* target, float distance, float cooldown) override;
+	virtual bool IsAIBusy() const override;
+	virtual float PerformAIAction(float distance) override;
+	virtual AActor* GetAITarget() const override { return mpTarget; }
+	virtual AActor* ChooseAITarget() override;
+	virtual float GetAIStartCooldown() const override;
+	virtual TSubclassOf<AActor> GetAITargetClass() const override;
+	// End of AI manager interface
+
+	virtual void ResetUnit() override;
+	virtual void ReceiveDamageFrom(ABaseUnit* instigator, float damage) override;
+
+	UFUNCTION(BlueprintCallable)
+	/**   @brief Gets the players the gladiator is most angry at, for attacks that hit several targets
+	*    @param {int} count - how many players to get
+	*    @return {TArray<AActor*>} - up to count players, most threat first
+	*/
+	TArray<AActor*> GetTopThreats(int count) const;
+
+	UFUNCTION(BlueprintCallable)
+	/**   @brief Gets how much threat a player has built up against the gladiator
+	*    @param {AActor*} player - the player to check
+	*    @return {float} - the player's threat, 0 if they have none
+	*/
+	float GetThreat(const AActor* player) const;
 	
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
 	AActor* mpTarget;
@@ -57,6 +78,21 @@ public:
 
 	UFUNCTION(BlueprintImplementableEvent)
 	void RangedAttack();
+
+	UFUNCTION(BlueprintCallable)
+	/**   @brief Fires a fan of native projectiles, use this from RangedAttack instead of spawning missile actors.
+	*		Only does anything on the server, which sends the shot to every client to draw
+	*    @param {FVector} origin - where the projectiles start
+	*    @param {FVector} direction - the direction of the middle projectile
+	*    @param {int} count - how many projectiles to fire
+	*    @param {float} spreadAngle - angle in degrees between the first and last projectile
+	*    @param {float} speed - speed of each projectile
+	*    @param {float} damage - damage dealt by each projectile
+	*/
+	void FireProjectiles(FVector origin, FVector direction, int count = 1, float spreadAngle = 0.0f, float speed = 2000.0f, float damage = 10.0f);
+
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastFireProjectiles(FVector_NetQuantize origin, FVector_NetQuantizeNormal direction, uint8 count, float spreadAngle, float speed, float damage);
 	
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
@@ -78,4 +114,37 @@ public:
 	
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
 	bool mIsAttacking;
+
+	// Threat gained per point of damage a player deals to the gladiator
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Threat)
+	float mDamageThreatScale;
+
+	// Threat per second gained by a player standing right next to the gladiator, falling off to 0 at mThreatRadius
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Threat)
+	float mProximityThreatPerSecond;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Threat)
+	float mThreatRadius;
+
+	// Fraction of every player's threat lost per second
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Threat)
+	float mThreatDecayPerSecond;
+
+	// Seconds between proximity and decay updates
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Threat)
+	float mThreatUpdateInterval;
+
+	// A player needs this many times the current target's threat to take the gladiator's attention
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Threat)
+	float mTargetSwitchRatio;
+
+protected:
+	// Adds proximity threat and decays the table if enough time has passed since the last update
+	void UpdateThreat();
+
+	// Switches mpTarget to the top threat if it has overtaken the current target
+	void UpdateThreatTarget();
+
+	FThreatTable mThreatTable;
+	float mLastThreatUpdateTime;
 };
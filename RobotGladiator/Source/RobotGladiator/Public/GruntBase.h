@@ -18,13 +18,6 @@ UCLASS()
 class ROBOTGLADIATOR_API AGruntBase : public ABaseUnit
 {
 	GENERATED_BODY()
-	
-
-	/** @brief Get the closes player to the gladiator
-	*	@param {TArray<AActor*>} Array - array of actors to choose from -
-	*   @return {AActor*} - the closest player to the gladiator
-	*/
-	// AActor* GetClosestPlayer(TArray<AActor*> Array);
 
 protected:
 
@@ -33,9 +26,36 @@ protected:
 
 public:
 
-	AGruntBase();
+	// Grunts use the crowd avoidance movement component
+	AGruntBase(const FObjectInitializer& ObjectInitializer);
+
+	// AI manager interface
+	virtual void ReceiveAIState(AActor* target, float distance, float cooldown) override;
+	virtual float PerformAIAction(float distance) override;
+	virtual AActor* GetAITarget() const override { return mpTarget; }
+	// End of AI manager interface
+
+	virtual void ResetUnit() override;
 
 	UFUNCTION(BlueprintCallable, Category="grunt")
 		AActor* GetClosestPlayer(TArray<AActor*> Array);
 
+	// Far away grunts follow the flow field instead of walking normally
+	virtual void SetAILOD(EAILODTier tier, float movementTickInterval) override;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
+	AActor* mpTarget;
+
+	UFUNCTION(BlueprintImplementableEvent)
+	void MeleeAttack();
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float mMeleeRange;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float mDistanceToTarget;
+
+	// Time the AI manager waits after a swing before the grunt can swing again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float mMeleeCoolDown;
 };
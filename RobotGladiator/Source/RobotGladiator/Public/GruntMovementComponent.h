@@ -0,0 +1,74 @@
+/**
+ * @file GruntMovementComponent.h
+ * @brief Declares the movement component used by grunts, which takes its avoidance from the crowd avoidance subsystem
+ *		and has a cheap flow field movement mode for grunts far away from every player
+ * @dependencies UnitMovementComponent.h, CrowdAvoidanceSubsystem.h, ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UnitMovementComponent.h"
+#include "GruntMovementComponent.generated.h"
+
+UENUM(BlueprintType)
+enum EGruntMovementMode
+{
+	CUSTOM_NONE			UMETA(Hidden),							// CustomMovementMode is 0 whenever the movement mode isn't custom
+	CUSTOM_FLOW_FIELD	UMETA(DisplayName = "Flow Field"),		// Walks tile to tile along the arena flow field
+};
+
+/**
+ * Uses the engine's avoidance hook but replaces the per component avoidance manager query with the steering that
+ * the crowd avoidance subsystem worked out for every grunt in one batch.
+ *
+ * Grunts that are far from every player can switch to the flow field mode, which walks them from tile center to
+ * tile center along the arena's flow field and snaps them to the tile heights instead of sweeping for the floor.
+ * The switch is made by the grunt's AI LOD tier, which only the UUnitAIManager sets, so only grunts with
+ * mUseNativeAI turned on ever use the flow field mode
+ */
+UCLASS()
+class ROBOTGLADIATOR_API UGruntMovementComponent : public UUnitMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	UGruntMovementComponent();
+
+	/** @brief Switches between the flow field mode and normal walking. Grunts that are jumping or falling switch
+	 *		once they land
+	 *  @param {bool} enable - True to follow the flow field, false to walk normally
+	 */
+	void SetSimplifiedMovement(bool enable);
+
+	// Returns true while following the flow field
+	bool IsUsingSimplifiedMovement() const { return MovementMode == MOVE_Custom && CustomMovementMode == CUSTOM_FLOW_FIELD; }
+
+	// The flow field mode walks at the grunt's scaled walk speed rather than the custom mode speed
+	virtual float GetMaxSpeed() const override;
+
+protected:
+	// Adds the crowd avoidance steering to the velocity
+	virtual void CalcAvoidanceVelocity(float DeltaTime) override;
+
+	// The crowd avoidance subsystem gathers its own state, there is nothing to send to the avoidance manager
+	virtual void UpdateDefaultAvoidance() override {}
+
+	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
+
+	// Picks up a switch to the flow field that was asked for while the grunt was in the air
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+
+	// Moves towards the next tile of the flow field without any collision checks
+	void PhysFlowField(float deltaTime, int32 Iterations);
+
+	// Returns true if the grunt is on a tile of the arena, the flow field can't move it anywhere else
+	bool IsOverArena() const;
+
+private:
+	// The last switch asked for, held until the grunt is on the ground
+	bool mWantsSimplifiedMovement;
+};
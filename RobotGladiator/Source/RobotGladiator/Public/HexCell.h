@@ -73,6 +73,13 @@ int HexDistance(HexCell a, HexCell b);
 HexCell GetHexDirection(int face);
 // Gets the neighboring cell to the given cell
 HexCell GetNeighbor(HexCell cell, int face);
+/** @brief Rounds fractional Cube coordinates to the cell that contains them
+ *  @param {float} q - Fractional q component
+ *  @param {float} r - Fractional r component
+ *  @param {float} s - Fractional s component
+ *  @return {HexCell} - Returns the nearest HexCell (stored in Cube coordinates)
+ */
+HexCell HexRound(float q, float r, float s);
 
 // Operator overloads
 
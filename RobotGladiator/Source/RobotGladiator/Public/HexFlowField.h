@@ -0,0 +1,46 @@
+/**
+ * @file HexFlowField.h
+ * @brief Declares a flow field over the arena tiles that points every tile towards the nearest goal tile
+ * @dependencies ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ *	https://www.redblobgames.com/pathfinding/tower-defense/
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** @brief Stores, for every tile, the neighbouring tile to step onto to get closer to the nearest goal and how many
+ *		steps away that goal is. Built with one breadth first search out from all of the goals at once, so any number
+ *		of units can follow it for the cost of a lookup
+ */
+class ROBOTGLADIATOR_API FHexFlowField
+{
+public:
+	FHexFlowField();
+
+	/** @brief Rebuilds the field for a set of goals
+	 *  @param {AArenaGrid*} grid - The grid to build the field over
+	 *  @param {TArray<int>} goals - The tiles to lead towards, invalid tiles are ignored
+	 *  @param {float} maxClimb - The highest a unit can step up between neighbouring tiles, 0 or less for no limit
+	 */
+	void Build(const class AArenaGrid* grid, const TArray<int>& goals, float maxClimb);
+
+	// Clears the field so no tile leads anywhere
+	void Reset();
+
+	// Returns the tile to step onto from a tile, the tile itself for a goal, INDEX_NONE if no goal can be reached
+	int GetNextTile(int tile) const { return mNextTile.IsValidIndex(tile) ? mNextTile[tile] : INDEX_NONE; }
+
+	// Returns the number of steps from a tile to the nearest goal, INDEX_NONE if no goal can be reached
+	int GetDistance(int tile) const { return mDistance.IsValidIndex(tile) ? mDistance[tile] : INDEX_NONE; }
+
+private:
+	TArray<int> mNextTile;
+	TArray<int> mDistance;
+
+	// Reused by every build
+	TArray<int> mFrontier;
+};
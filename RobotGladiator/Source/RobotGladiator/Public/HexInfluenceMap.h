@@ -0,0 +1,91 @@
+/**
+ * @file HexInfluenceMap.h
+ * @brief Declares a per-tile influence map used by the AI to reason about the arena without iterating actors
+ * @dependencies ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ *	https://www.redblobgames.com/grids/hexagons/
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HexInfluenceMap.generated.h"
+
+UENUM(BlueprintType)
+enum EInfluenceLayer
+{
+	THREAT		UMETA(DisplayName = "Threat"),		// Presence of players
+	ALLIES		UMETA(DisplayName = "Allies"),		// Presence of gladiators and grunts
+	HAZARD		UMETA(DisplayName = "Hazard"),		// Toxic toppers and other damaging tiles
+
+	NUM_INFLUENCE_LAYERS UMETA(Hidden)
+};
+
+/** @brief Stores one float per tile per layer. Sources are stamped in and out incrementally as they change tiles,
+ *		and the remembered influence decays towards the current presence in one vectorized pass per frame
+ */
+class ROBOTGLADIATOR_API FHexInfluenceMap
+{
+public:
+	FHexInfluenceMap();
+
+	/** @brief Sizes the map for a grid and precomputes how a source spreads to the tiles around it
+	 *  @param {AArenaGrid*} grid - The grid to build the map for
+	 *  @param {int} spreadRings - How many rings around a source receive some of its influence
+	 */
+	void Init(const class AArenaGrid* grid, int spreadRings);
+
+	// Clears every layer
+	void Reset();
+
+	// Clears a single layer
+	void ResetLayer(EInfluenceLayer layer);
+
+	/** @brief Stamps a source into a layer, spreading it to the surrounding tiles
+	 *  @param {EInfluenceLayer} layer - The layer to stamp into
+	 *  @param {int} tile - The tile the source is on. Invalid tiles are ignored
+	 *  @param {float} strength - Influence at the source's own tile, negative to remove a source
+	 */
+	void AddSource(EInfluenceLayer layer, int tile, float strength);
+
+	/** @brief Moves a source from one tile to another
+	 *  @param {EInfluenceLayer} layer - The layer the source is stamped into
+	 *  @param {int} fromTile - The tile the source was stamped on
+	 *  @param {int} toTile - The tile the source is now on
+	 *  @param {float} strength - The strength the source was stamped with
+	 */
+	void MoveSource(EInfluenceLayer layer, int fromTile, int toTile, float strength);
+
+	/** @brief Decays the remembered influence of every tile in every layer, never dropping below current presence
+	 *  @param {float} deltaTime - Time elapsed since the last decay
+	 *  @param {float} halfLife - Time in seconds for remembered influence to halve
+	 */
+	void Decay(float deltaTime, float halfLife);
+
+	/** @brief Gets the influence of a layer at a tile
+	 *  @param {EInfluenceLayer} layer - The layer to sample
+	 *  @param {int} tile - The tile to sample
+	 *  @return {float} - The influence at the tile, 0 if the tile is invalid
+	 */
+	float Sample(EInfluenceLayer layer, int tile) const
+	{
+		return (tile >= 0 && tile < mNumTiles) ? mValue[layer][tile] : 0.0f;
+	}
+
+	int GetNumTiles() const { return mNumTiles; }
+
+private:
+	int mNumTiles;
+
+	// Influence from the sources currently on the grid, padded to a multiple of 4 for the decay pass
+	TArray<float> mPresence[NUM_INFLUENCE_LAYERS];
+	// Remembered influence that decays towards the presence, this is what gets sampled
+	TArray<float> mValue[NUM_INFLUENCE_LAYERS];
+
+	// Tiles and weights each source tile spreads to, mSpreadStart[tile] to mSpreadStart[tile + 1]
+	TArray<int> mSpreadStart;
+	TArray<int> mSpreadTiles;
+	TArray<float> mSpreadWeights;
+};
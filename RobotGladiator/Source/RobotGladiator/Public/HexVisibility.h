@@ -0,0 +1,57 @@
+/**
+ * @file HexVisibility.h
+ * @brief Declares a table of which arena tiles can see each other, built from the floor heights a slice at a time
+ * @dependencies ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ *	https://www.redblobgames.com/grids/hexagons/
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** @brief Stores one bit per pair of tiles, set if someone standing on the first tile can see someone standing on the
+ *		second. The table is rebuilt whenever the floor heights change, a few rows each frame so moving the tiles
+ *		doesn't cost a hitch. Pairs that haven't been rebuilt yet are checked directly against the heights instead
+ */
+class ROBOTGLADIATOR_API FHexVisibility
+{
+public:
+	FHexVisibility();
+
+	/** @brief Restarts the build if the floor has moved since it started, then carries it on
+	 *  @param {AArenaGrid*} grid - The grid to build the table for
+	 *  @param {float} eyeHeight - Height above a tile's surface that lines of sight are checked from and to
+	 *  @param {int} maxPairs - Most pairs of tiles checked by this call
+	 */
+	void Update(const class AArenaGrid* grid, float eyeHeight, int maxPairs);
+
+	// Clears the table, the next update starts a fresh build
+	void Reset();
+
+	/** @brief Checks if someone on one tile can see someone on another
+	 *  @param {AArenaGrid*} grid - The grid the table was built for, used for pairs that aren't built yet
+	 *  @param {int} fromTile - The tile looking
+	 *  @param {int} toTile - The tile being looked at
+	 *  @param {float} eyeHeight - Height above each tile's surface, should match the height given to Update
+	 *  @return {bool} - true if nothing on the floor blocks the view, always true for tiles off the grid
+	 */
+	bool IsVisible(const class AArenaGrid* grid, int fromTile, int toTile, float eyeHeight) const;
+
+	// Returns true once every pair has been checked against the current floor
+	bool IsComplete() const { return mRow >= mNumTiles; }
+
+private:
+	// Bit fromTile * mNumTiles + toTile is set if toTile can be seen from fromTile
+	TBitArray<> mBits;
+	int mNumTiles;
+
+	// Rows before mRow are built, mColumn is how far into mRow the build has got
+	int mRow;
+	int mColumn;
+
+	// The floor heights the current build is for
+	TArray<float> mHeights;
+};
@@ -0,0 +1,131 @@
+/**
+ * @file LagCompensationSubsystem.h
+ * @brief Declares a world subsystem that keeps a short history of where every unit was so the server can check
+ *		players' hits against what they saw
+ * @dependencies WorldSubsystem.h, Tickable.h, PositionHistory.h, BaseUnit.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "PositionHistory.h"
+#include "LagCompensationSubsystem.generated.h"
+
+class ABaseUnit;
+
+/**
+ * The server samples every unit's location and yaw into a position history at a fixed rate. When a remote player
+ * hits something, the time they saw it at (now minus their round trip and the interpolation delay) is looked up in
+ * the history and the target's position at that time is used for the check. Actors are never moved back and forth,
+ * so a rewind is a search over the sample times plus two reads per unit
+ */
+UCLASS(config = Game)
+class ROBOTGLADIATOR_API ULagCompensationSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	ULagCompensationSubsystem();
+
+	/** @brief Gets the lag compensation subsystem for the world an object is in
+	 *  @param {UObject*} worldContextObject - Any object in the world
+	 *  @return {ULagCompensationSubsystem*} - The subsystem, or nullptr if the object isn't in a world
+	 */
+	static ULagCompensationSubsystem* Get(const UObject* worldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	/** @brief Starts recording a unit's position
+	 *  @param {ABaseUnit*} unit - The unit to record
+	 */
+	void RegisterUnit(ABaseUnit* unit);
+
+	/** @brief Stops recording a unit's position
+	 *  @param {ABaseUnit*} unit - The unit to stop recording
+	 */
+	void UnregisterUnit(ABaseUnit* unit);
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Gets the world time an actor was seeing when it acted, now for the server's own players and the AI
+	 *  @param {AActor*} shooter - The actor that attacked
+	 *  @return {float} - The world time to rewind to
+	 */
+	float GetShooterTime(const AActor* shooter) const;
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Gets where a unit was at a time in the past
+	 *  @param {ABaseUnit*} unit - The unit to look up
+	 *  @param {float} time - The world time, clamped to the history that is kept
+	 *  @param {FVector&} outLocation - The unit's location at the time
+	 *  @return {bool} - false if the unit isn't recorded, outLocation is then its current location
+	 */
+	bool GetLocationAtTime(const ABaseUnit* unit, float time, FVector& outLocation) const;
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Checks a hit a player reported against where the target was when the player saw it
+	 *  @param {AActor*} shooter - The actor that fired or swung
+	 *  @param {ABaseUnit*} target - The unit that was hit
+	 *  @param {FVector} hitLocation - Where the hit landed
+	 *  @param {float} tolerance - Extra distance allowed around the target's capsule
+	 *  @return {bool} - true if the hit location was on the target's rewound capsule
+	 */
+	bool ValidateHit(const AActor* shooter, const ABaseUnit* target, FVector hitLocation, float tolerance = 20.0f) const;
+
+	/** @brief Finds the history slots for a time, for checking many units at the same time
+	 *  @return {bool} - false if nothing has been recorded yet
+	 */
+	bool FindSlots(float time, int& outNewer, int& outOlder, float& outAlpha) const { return mHistory.FindSlots(time, outNewer, outOlder, outAlpha); }
+
+	/** @brief Gets where a unit was between two slots found by FindSlots
+	 *  @return {FVector} - The unit's rewound location, or its current location if it isn't recorded
+	 */
+	FVector GetLocationBetweenSlots(const ABaseUnit* unit, int newer, int older, float alpha) const;
+
+public:
+	// Seconds of history kept for every unit
+	UPROPERTY(config)
+	float HistorySeconds;
+
+	// Samples taken per second
+	UPROPERTY(config)
+	float SampleRate;
+
+	// World units per step of a stored coordinate around the arena, coarsened if a unit is found out of range
+	UPROPERTY(config)
+	float PositionQuantum;
+
+	// Seconds clients render other actors behind the latest update they received
+	UPROPERTY(config)
+	float InterpolationDelay;
+
+	// Longest rewind allowed, stops players with terrible connections from hitting things long gone
+	UPROPERTY(config)
+	float MaxRewindSeconds;
+
+private:
+	// Coarsens the history if a location is too far from its origin to store, so it is never clamped
+	void FitHistory(const FVector& location);
+
+private:
+	FPositionHistory mHistory;
+
+	// Units in history handle order
+	UPROPERTY()
+	TArray<ABaseUnit*> mUnits;
+
+	// Time that hasn't made up a whole sample yet
+	float mAccumulator;
+};
@@ -0,0 +1,98 @@
+/**
+ * @file MeleeResolverSubsystem.h
+ * @brief Declares a world subsystem that resolves every melee swing of a frame against the arena occupancy index
+ * @dependencies WorldSubsystem.h, Tickable.h, ArenaGrid.h, DamageQueueSubsystem.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "MeleeResolverSubsystem.generated.h"
+
+class ABaseUnit;
+class AArenaGrid;
+
+/** @brief A melee attack waiting to be resolved
+ */
+struct FMeleeSwing
+{
+	ABaseUnit* Attacker;
+	FVector Origin;
+	FVector2D Facing;			// Normalized on the ground plane
+	float CosHalfAngle;
+	float Range;
+	float Damage;
+	float RewindTime;			// World time the targets are checked at, negative to use where they are now
+};
+
+/**
+ * Swings are queued as arcs (origin, facing, angle and range) and resolved together once per frame. The units
+ * standing on the tiles a swing can reach are copied into packed arrays and tested four at a time, and every hit
+ * becomes a damage event in the damage queue. Nothing goes through physics overlaps or sweeps
+ */
+UCLASS()
+class ROBOTGLADIATOR_API UMeleeResolverSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UMeleeResolverSubsystem();
+
+	/** @brief Gets the melee resolver for the world an object is in
+	 *  @param {UObject*} worldContextObject - Any object in the world
+	 *  @return {UMeleeResolverSubsystem*} - The melee resolver, or nullptr if the object isn't in a world
+	 */
+	static UMeleeResolverSubsystem* Get(const UObject* worldContextObject);
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	/** @brief Queues a swing to be resolved at the end of the frame
+	 *  @param {ABaseUnit*} attacker - The unit swinging, it only hits units on the other side
+	 *  @param {FVector} origin - Where the swing starts
+	 *  @param {FVector} facing - The direction the swing is aimed, only the ground plane part is used
+	 *  @param {float} angle - Width of the arc in degrees
+	 *  @param {float} range - How far the swing reaches
+	 *  @param {float} damage - Damage dealt to every unit hit
+	 */
+	void QueueSwing(ABaseUnit* attacker, FVector origin, FVector facing, float angle, float range, float damage);
+
+	// Resolves every queued swing
+	void ResolveSwings();
+
+public:
+	// How far above or below the swing origin a unit's capsule can be and still be hit
+	float VerticalReach;
+
+private:
+	// Copies the units a swing can reach into the candidate arrays, padded to a multiple of 4
+	void GatherCandidates(const FMeleeSwing& swing);
+
+	// Tests the candidates against a swing four at a time and queues damage for the ones it hits
+	void TestCandidates(const FMeleeSwing& swing);
+
+private:
+	TArray<FMeleeSwing> mSwings;
+
+	UPROPERTY()
+	AArenaGrid* mpArena;
+
+	// Candidates for the swing being resolved
+	TArray<ABaseUnit*> mCandidates;
+	TArray<float> mCandidateX;
+	TArray<float> mCandidateY;
+	TArray<float> mCandidateZ;
+	TArray<float> mCandidateRadius;
+	TArray<float> mCandidateHalfHeight;
+};
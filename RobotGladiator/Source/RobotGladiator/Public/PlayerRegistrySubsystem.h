@@ -0,0 +1,109 @@
+/**
+ * @file PlayerRegistrySubsystem.h
+ * @brief Declares a world subsystem that keeps a live, spatially hashed registry of player pawns
+ * @dependencies WorldSubsystem.h, Tickable.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "PlayerRegistrySubsystem.generated.h"
+
+/**
+ * Players register themselves on BeginPlay and unregister on EndPlay. Their locations are bucketed into a uniform
+ * grid once per frame so nearest and radius queries only look at nearby cells instead of every actor in the world
+ */
+UCLASS()
+class ROBOTGLADIATOR_API UPlayerRegistrySubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UPlayerRegistrySubsystem();
+
+	/** @brief Gets the registry for the world an object is in
+	 *  @param {UObject*} worldContextObject - Any object in the world
+	 *  @return {UPlayerRegistrySubsystem*} - The registry, or nullptr if the object isn't in a world
+	 */
+	static UPlayerRegistrySubsystem* Get(const UObject* worldContextObject);
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	/** @brief Adds a player to the registry
+	 *  @param {AActor*} player - The player pawn to add
+	 */
+	void RegisterPlayer(AActor* player);
+
+	/** @brief Removes a player from the registry
+	 *  @param {AActor*} player - The player pawn to remove
+	 */
+	void UnregisterPlayer(AActor* player);
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Finds the closest registered player to a location
+	 *  @param {FVector} location - The location to search from
+	 *  @param {TSubclassOf<AActor>} classFilter - Only players of this class are considered, none for any player
+	 *  @param {AActor*} ignore - A player to skip, usually the one doing the search
+	 *  @return {AActor*} - The closest player, or nullptr if there are none
+	 */
+	AActor* FindClosestPlayer(FVector location, TSubclassOf<AActor> classFilter = nullptr, const AActor* ignore = nullptr) const;
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Finds up to count registered players, closest first
+	 *  @param {FVector} location - The location to search from
+	 *  @param {int} count - The maximum number of players to return
+	 *  @param {TArray<AActor*>&} outPlayers - Filled with the closest players, closest first
+	 */
+	void FindNearestPlayers(FVector location, int count, TArray<AActor*>& outPlayers) const;
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Finds every registered player within a radius of a location
+	 *  @param {FVector} location - The center of the search
+	 *  @param {float} radius - The radius of the search
+	 *  @param {TArray<AActor*>&} outPlayers - Filled with the players in range, in no particular order
+	 */
+	void FindPlayersInRadius(FVector location, float radius, TArray<AActor*>& outPlayers) const;
+
+	// Returns every registered player
+	const TArray<AActor*>& GetPlayers() const { return mPlayers; }
+
+private:
+	// Finds the grid cell a location falls into
+	FIntPoint GetCell(const FVector& location) const;
+
+	// Puts a player into the grid cell stored for it
+	void AddToCell(int index);
+
+	// Takes a player out of the grid cell stored for it
+	void RemoveFromCell(int index);
+
+	// Returns true if a player passes the class filter and isn't ignored
+	bool IsCandidate(int index, TSubclassOf<AActor> classFilter, const AActor* ignore) const;
+
+	// Returns how many rings of cells around a cell have to be searched to reach every player
+	int GetMaxRing(const FIntPoint& center) const;
+
+private:
+	// Size of a grid cell in world units
+	float mCellSize;
+
+	// The registered players and the grid cells they were in as of the last tick
+	UPROPERTY()
+	TArray<AActor*> mPlayers;
+	TArray<FIntPoint> mCells;
+
+	// Indices into mPlayers of the players in each grid cell
+	TMap<FIntPoint, TArray<int>> mGrid;
+};
@@ -0,0 +1,122 @@
+/**
+ * @file PositionHistory.h
+ * @brief Declares a fixed size ring buffer of quantized unit positions used to rewind hits on the server
+ * @dependencies None
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Every unit gets a block of NumSamples entries in a set of packed arrays: position as three 16 bit integers
+ * relative to an origin and yaw as a 16 bit angle, 8 bytes per unit per sample. All units are sampled together
+ * so one shared ring of timestamps says which slot holds which moment. Rewinding finds the two slots either side of
+ * a time once, then reads and blends two entries per unit, nothing is written back to any actor
+ */
+class ROBOTGLADIATOR_API FPositionHistory
+{
+public:
+	/** @brief Creates an empty history
+	 *  @param {int} numSamples - Samples kept for every unit, the oldest is overwritten when the ring is full
+	 *  @param {float} quantum - World units per step of a stored coordinate, the range is +-32767 steps
+	 *  @param {FVector} origin - Positions are stored relative to this
+	 */
+	FPositionHistory(int numSamples = 30, float quantum = 1.0f, FVector origin = FVector::ZeroVector);
+
+	// Clears the history and changes its size and precision
+	void Init(int numSamples, float quantum, FVector origin);
+
+	/** @brief Moves the origin and changes the precision, the history kept so far is converted rather than cleared
+	 *  @param {FVector} origin - Positions are stored relative to this
+	 *  @param {float} quantum - World units per step of a stored coordinate
+	 */
+	void Rebase(FVector origin, float quantum);
+
+	/** @brief Checks whether a location can be stored without being clamped
+	 *  @param {FVector} location - The location to check
+	 *  @return {bool} - true if every coordinate is within +-32767 steps of the origin
+	 */
+	bool IsInRange(const FVector& location) const;
+
+	FVector GetOrigin() const { return mOrigin; }
+	float GetQuantum() const { return mQuantum; }
+
+	/** @brief Adds a unit, every slot of its history starts at its current transform
+	 *  @param {FVector} location - The unit's location
+	 *  @param {float} yaw - The unit's yaw in degrees
+	 *  @return {int} - The unit's handle
+	 */
+	int AddUnit(const FVector& location, float yaw);
+
+	/** @brief Removes a unit, the last unit's history is moved into its place and takes over its handle
+	 *  @param {int} handle - The unit to remove
+	 */
+	void RemoveUnit(int handle);
+
+	/** @brief Moves the ring on to a new slot, call before writing the units for that moment
+	 *  @param {float} time - The world time of the sample
+	 */
+	void BeginSample(float time);
+
+	/** @brief Writes a unit's transform into the current slot
+	 *  @param {int} handle - The unit
+	 *  @param {FVector} location - The unit's location
+	 *  @param {float} yaw - The unit's yaw in degrees
+	 */
+	void WriteSample(int handle, const FVector& location, float yaw);
+
+	/** @brief Finds the two slots either side of a time, done once and shared by every unit checked at that time
+	 *  @param {float} time - The world time to rewind to, clamped to the history that is kept
+	 *  @param {int&} outNewer - The slot at or after the time
+	 *  @param {int&} outOlder - The slot at or before the time
+	 *  @param {float&} outAlpha - How far from the newer slot towards the older one the time is
+	 *  @return {bool} - false if nothing has been sampled yet
+	 */
+	bool FindSlots(float time, int& outNewer, int& outOlder, float& outAlpha) const;
+
+	/** @brief Reads a unit's transform between two slots found by FindSlots
+	 *  @param {int} handle - The unit
+	 *  @param {int} newer - The slot at or after the time
+	 *  @param {int} older - The slot at or before the time
+	 *  @param {float} alpha - How far from the newer slot towards the older one to blend
+	 *  @param {FVector&} outLocation - The unit's location at the time
+	 *  @param {float&} outYaw - The unit's yaw in degrees at the time
+	 */
+	void GetTransform(int handle, int newer, int older, float alpha, FVector& outLocation, float& outYaw) const;
+
+	// Returns the number of units
+	int GetNumUnits() const { return mNumUnits; }
+
+	// Returns the times of the oldest and newest samples kept
+	float GetOldestTime() const;
+	float GetNewestTime() const { return mNumRecorded > 0 ? mTimes[mHead] : 0.0f; }
+
+	// Returns the bytes allocated for the history
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// Converts between world coordinates and stored steps
+	int16 Quantize(float value, float origin) const;
+	float Dequantize(int16 value, float origin) const { return origin + value * mQuantum; }
+
+private:
+	// Unit handle * mNumSamples + slot
+	TArray<int16> mX;
+	TArray<int16> mY;
+	TArray<int16> mZ;
+	TArray<uint16> mYaw;
+
+	// Time of each slot and the slot written last
+	TArray<float> mTimes;
+	int mHead;
+	int mNumRecorded;
+
+	int mNumSamples;
+	int mNumUnits;
+	float mQuantum;
+	FVector mOrigin;
+};
@@ -0,0 +1,130 @@
+/**
+ * @file ProjectileSubsystem.h
+ * @brief Declares a world subsystem that simulates gladiator missiles as plain data instead of one actor per shot
+ * @dependencies WorldSubsystem.h, Tickable.h, ArenaGrid.h, DamageQueueSubsystem.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ProjectileSubsystem.generated.h"
+
+class ABaseUnit;
+class AArenaGrid;
+class UInstancedStaticMeshComponent;
+
+/**
+ * Every projectile is a row in a set of parallel arrays. Once per frame they are all moved in one (optionally
+ * parallel) pass and tested against the arena floor heights, then the survivors are tested against the units on
+ * their tile using the arena's occupancy index. Hits are sent to the damage queue. Projectiles are drawn by a
+ * single instanced mesh so thousands of them cost one draw call instead of thousands of actors.
+ *
+ * Projectiles are fired on every machine so clients can draw them, only the server's copies deal damage
+ */
+UCLASS(config = Game)
+class ROBOTGLADIATOR_API UProjectileSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UProjectileSubsystem();
+
+	/** @brief Gets the projectile subsystem for the world an object is in
+	 *  @param {UObject*} worldContextObject - Any object in the world
+	 *  @return {UProjectileSubsystem*} - The projectile subsystem, or nullptr if the object isn't in a world
+	 */
+	static UProjectileSubsystem* Get(const UObject* worldContextObject);
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	/** @brief Fires a projectile
+	 *  @param {FVector} origin - Where the projectile starts
+	 *  @param {FVector} velocity - Direction and speed of the projectile
+	 *  @param {float} damage - Damage dealt to the unit it hits
+	 *  @param {ABaseUnit*} instigator - The unit that fired it, it can't hit units on the same side
+	 *  @param {bool} dealsDamage - False for copies that are only drawn, such as on clients
+	 */
+	void FireProjectile(FVector origin, FVector velocity, float damage, ABaseUnit* instigator, bool dealsDamage);
+
+	// Removes every projectile
+	void ClearProjectiles();
+
+	// Returns the number of projectiles in flight
+	int GetNumProjectiles() const { return mPositions.Num(); }
+
+public:
+	// Seconds a projectile flies before it is removed
+	UPROPERTY(config)
+	float ProjectileLifetime;
+
+	// Collision radius of a projectile
+	UPROPERTY(config)
+	float ProjectileRadius;
+
+	// Mesh used to draw projectiles and its scale
+	UPROPERTY(config)
+	FSoftObjectPath ProjectileMesh;
+	UPROPERTY(config)
+	float ProjectileMeshScale;
+
+	// Below this many projectiles they are moved on the game thread only
+	int ParallelThreshold;
+
+private:
+	// Moves every projectile and flags the ones that hit the floor or ran out of time
+	void IntegrateProjectiles(float deltaTime);
+
+	// Tests the projectiles still flying against the units on and around their tile
+	void CollideWithUnits();
+
+	// Removes every flagged projectile
+	void RemoveDeadProjectiles();
+
+	// Moves the instanced mesh to match the projectiles
+	void UpdateVisuals();
+
+	// Creates the actor that owns the instanced mesh, nothing is drawn on a dedicated server
+	void CreateVisualProxy();
+
+private:
+	// Per projectile state, all indexed the same way
+	TArray<FVector> mPositions;
+	TArray<FVector> mVelocities;
+	TArray<float> mDamage;
+	TArray<float> mTimeLeft;
+	TArray<int> mTiles;
+	TArray<uint8> mFlags;
+	UPROPERTY()
+	TArray<ABaseUnit*> mInstigators;
+
+	enum EProjectileFlags : uint8
+	{
+		PROJECTILE_NONE = 0,
+		PROJECTILE_DEALS_DAMAGE = 1 << 0,
+		PROJECTILE_FROM_PLAYER = 1 << 1,	// Fired by a player so it hits enemies instead of players
+		PROJECTILE_DEAD = 1 << 2,
+	};
+
+	UPROPERTY()
+	AArenaGrid* mpArena;
+
+	UPROPERTY()
+	AActor* mpVisualProxy;
+	UPROPERTY()
+	UInstancedStaticMeshComponent* mpInstances;
+
+	// Reused every frame to update the instanced mesh
+	TArray<FTransform> mInstanceTransforms;
+};
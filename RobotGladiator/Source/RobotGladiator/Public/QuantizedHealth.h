@@ -0,0 +1,59 @@
+/**
+ * @file QuantizedHealth.h
+ * @brief Declares a unit's health packed into a few bits as a fraction of its max health for replication
+ * @dependencies None
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "QuantizedHealth.generated.h"
+
+USTRUCT()
+/** @brief Health as a fraction of max health in HealthBits bits. Only dead units are 0 and only units at full
+ *		health are the top value, so clients never show a living unit as dead or a hurt one as full
+ */
+struct ROBOTGLADIATOR_API FQuantizedHealth
+{
+	GENERATED_BODY()
+
+	// Bits sent per update, 10 bits is finer than a health bar can show
+	static const int HealthBits = 10;
+	static const uint16 MaxValue = (1 << HealthBits) - 1;
+
+	UPROPERTY()
+	uint16 Value;
+
+	FQuantizedHealth()
+		: Value(0){}
+
+	/** @brief Packs health into the fraction
+	 *  @param {float} health - The unit's health
+	 *  @param {float} maxHealth - The unit's max health
+	 */
+	void Set(float health, float maxHealth);
+
+	/** @brief Unpacks the fraction back into health
+	 *  @param {float} maxHealth - The unit's max health
+	 *  @return {float} - The health, accurate to 1 / MaxValue of max health
+	 */
+	float Get(float maxHealth) const;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FQuantizedHealth& other) const { return Value == other.Value; }
+	bool operator!=(const FQuantizedHealth& other) const { return Value != other.Value; }
+};
+
+template<>
+struct TStructOpsTypeTraits<FQuantizedHealth> : public TStructOpsTypeTraitsBase2<FQuantizedHealth>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
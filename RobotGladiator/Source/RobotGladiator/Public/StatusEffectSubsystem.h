@@ -0,0 +1,175 @@
+/**
+ * @file StatusEffectSubsystem.h
+ * @brief Declares a world subsystem that runs every damage over time, heal over time and buff effect in one batched pass
+ * @dependencies WorldSubsystem.h, Tickable.h, BaseUnit.h, DamageQueueSubsystem.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "StatusEffectSubsystem.generated.h"
+
+class ABaseUnit;
+
+UENUM(BlueprintType)
+enum EStatusStacking
+{
+	STACK_REFRESH		UMETA(DisplayName = "Refresh"),			// One instance, reapplying resets its duration and keeps the stronger rate
+	STACK_INTENSITY		UMETA(DisplayName = "Intensity"),		// One instance, reapplying adds a stack up to MaxStacks and resets its duration
+	STACK_INDEPENDENT	UMETA(DisplayName = "Independent"),		// Every application runs on its own, up to MaxStacks at once
+
+	NUM_STATUS_STACKING UMETA(Hidden)
+};
+
+/** @brief Describes an effect to put on a unit
+ */
+USTRUCT(BlueprintType)
+struct FStatusEffectSpec
+{
+	GENERATED_BODY()
+
+	// Effects with the same id on the same unit stack with each other
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName EffectId;
+
+	// Health per second per stack, positive heals and negative damages
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float HealthPerSecond;
+
+	// Multiplies the unit's walk speed once per stack, 1 leaves it alone
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float SpeedMultiplier;
+
+	// Seconds the effect lasts, 0 or less lasts until it is removed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Duration;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TEnumAsByte<EStatusStacking> Stacking;
+
+	// Most stacks (intensity) or instances (independent) a unit can have of this effect
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int MaxStacks;
+
+	FStatusEffectSpec()
+		: EffectId(NAME_None), HealthPerSecond(0.0f), SpeedMultiplier(1.0f), Duration(0.0f), Stacking(STACK_REFRESH), MaxStacks(1){}
+};
+
+/**
+ * Every running effect is a row in a set of packed arrays, keyed by the handle of the unit it is on. Effects are
+ * stepped together at a fixed rate: each step adds up the health change of every effect into a per unit total and
+ * then applies that total once per unit, heals directly and damage through the damage queue. Speed buffs are
+ * only recalculated for units whose speed effects changed, and become the unit's replicated speed scale which its
+ * movement component applies on top of the unit's own walk speed. Stacking is decided per effect by its spec.
+ * Effects only run on the server, health and the speed scale are replicated as usual
+ */
+UCLASS(config = Game)
+class ROBOTGLADIATOR_API UStatusEffectSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UStatusEffectSubsystem();
+
+	/** @brief Gets the status effect subsystem for the world an object is in
+	 *  @param {UObject*} worldContextObject - Any object in the world
+	 *  @return {UStatusEffectSubsystem*} - The subsystem, or nullptr if the object isn't in a world
+	 */
+	static UStatusEffectSubsystem* Get(const UObject* worldContextObject);
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Puts an effect on a unit, following the effect's stacking rule if the unit already has it
+	 *  @param {ABaseUnit*} target - The unit to affect
+	 *  @param {FStatusEffectSpec} spec - The effect to apply
+	 *  @return {bool} - true if the effect was applied
+	 */
+	bool ApplyEffect(ABaseUnit* target, const FStatusEffectSpec& spec);
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Removes every instance of an effect from a unit
+	 *  @param {ABaseUnit*} target - The unit to clear
+	 *  @param {FName} effectId - The effect to remove
+	 *  @return {int} - The number of instances removed
+	 */
+	int RemoveEffect(ABaseUnit* target, FName effectId);
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Gets how many stacks of an effect a unit has, counting every instance of independent effects
+	 *  @param {ABaseUnit*} target - The unit to check
+	 *  @param {FName} effectId - The effect to count
+	 *  @return {int} - The number of stacks, 0 if the unit doesn't have the effect
+	 */
+	int GetStacks(const ABaseUnit* target, FName effectId) const;
+
+	/** @brief Removes every effect from a unit and stops tracking it
+	 *  @param {ABaseUnit*} unit - The unit to clear
+	 */
+	void RemoveUnit(ABaseUnit* unit);
+
+	// Returns the number of running effects
+	int GetNumEffects() const { return mEffectUnits.Num(); }
+
+public:
+	// Seconds between effect steps
+	UPROPERTY(config)
+	float EffectTickInterval;
+
+	// Most steps run in one frame, stops a long hitch from applying a burst of effect ticks
+	UPROPERTY(config)
+	int MaxStepsPerFrame;
+
+private:
+	// Moves every effect forward by one step and applies the health changes
+	void StepEffects(float stepLength);
+
+	// Gets a unit's handle, adding the unit if it doesn't have one yet
+	int FindOrAddUnit(ABaseUnit* unit);
+
+	// Finds an effect on a unit, the one closest to running out for independent effects
+	int FindEffect(int unitHandle, FName effectId) const;
+
+	// Adds an effect row for a unit
+	void AddEffectRow(int unitHandle, const FStatusEffectSpec& spec);
+
+	// Removes an effect row, the last row is swapped into its place
+	void RemoveEffectRow(int effect);
+
+	// Sets the speed scale of every unit whose speed effects changed
+	void ApplySpeedChanges();
+
+private:
+	// Per unit state, all indexed by the unit's status handle
+	UPROPERTY()
+	TArray<ABaseUnit*> mUnits;
+	TArray<float> mHealthDeltas;		// Health change collected during a step
+	TArray<float> mSpeedScales;			// Walk speed multiplier from every speed effect
+	TArray<int> mEffectCounts;			// Number of effect rows on each unit
+	TArray<bool> mSpeedDirty;			// The unit's speed effects changed since its speed was last set
+
+	// Per effect state, all indexed by the effect's row
+	TArray<int> mEffectUnits;
+	TArray<FName> mEffectIds;
+	TArray<float> mEffectRates;
+	TArray<float> mEffectSpeeds;
+	TArray<float> mEffectTimeLeft;		// Negative for effects that last until removed
+	TArray<int> mEffectStacks;
+	TArray<uint8> mEffectStacking;
+
+	// Time that hasn't made up a whole step yet
+	float mAccumulator;
+	bool mHasDirtySpeeds;
+};
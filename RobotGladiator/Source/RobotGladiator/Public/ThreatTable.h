@@ -0,0 +1,93 @@
+/**
+ * @file ThreatTable.h
+ * @brief Declares a threat table that ranks the actors a unit is fighting by how much threat they have built up
+ * @dependencies None
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Threat is kept in an indexed max heap with a map from each source to its place in the heap, so adding threat,
+ * removing a source and finding the top threat are all O(log n) or better, and the top k are found without sorting
+ * everything. Decay scales every value by the same amount which never changes the order, so instead of touching
+ * every entry it is folded into one shared scale that the stored values are multiplied by
+ */
+class ROBOTGLADIATOR_API FThreatTable
+{
+public:
+	FThreatTable();
+
+	/** @brief Adds threat for a source, adding the source if it isn't in the table
+	 *  @param {AActor*} source - The actor that caused the threat
+	 *  @param {float} amount - How much threat to add
+	 */
+	void AddThreat(AActor* source, float amount);
+
+	/** @brief Scales the threat of every source
+	 *  @param {float} scale - Multiplier between 0 and 1 applied to every value
+	 */
+	void Decay(float scale);
+
+	/** @brief Takes a source out of the table
+	 *  @param {AActor*} source - The actor to remove
+	 *  @return {bool} - true if the source was in the table
+	 */
+	bool Remove(const AActor* source);
+
+	/** @brief Removes sources that were destroyed or whose threat decayed below a minimum
+	 *  @param {float} minThreat - Sources with less threat than this are dropped
+	 */
+	void RemoveStale(float minThreat);
+
+	// Empties the table
+	void Reset();
+
+	// Returns the source with the most threat, nullptr if the table is empty
+	AActor* GetTop() const;
+
+	// Returns the threat of a source, 0 if it isn't in the table
+	float GetThreat(const AActor* source) const;
+
+	/** @brief Gets the sources with the most threat, highest first
+	 *  @param {int} count - How many sources to get
+	 *  @param {TArray<AActor*>&} outSources - Filled with up to count sources
+	 */
+	void GetTopK(int count, TArray<AActor*>& outSources) const;
+
+	// Returns the number of sources in the table
+	int Num() const { return mSources.Num(); }
+
+private:
+	// Moves an entry towards the root or the leaves until the heap is in order again
+	void SiftUp(int index);
+	void SiftDown(int index);
+
+	// Swaps two heap entries and updates their places in the index
+	void SwapEntries(int a, int b);
+
+	// Removes the entry at a heap index
+	void RemoveAt(int index);
+
+	// Applies the shared scale to every stored value, done before it gets small enough to lose precision
+	void Renormalize();
+
+private:
+	// The heap, entry 0 has the most threat. Values are stored divided by mScale
+	TArray<TWeakObjectPtr<AActor>> mSources;
+	TArray<float> mValues;
+
+	// The pointer each source was added with, kept so its entry can still be found after the actor is gone.
+	// Keys are only compared and never followed
+	TArray<const AActor*> mKeys;
+
+	// Place of every source in the heap
+	TMap<const AActor*, int> mIndices;
+
+	// Every stored value is multiplied by this to get the real threat
+	float mScale;
+};
@@ -0,0 +1,74 @@
+/**
+ * @file TileAreaEffects.h
+ * @brief Declares the tile keyed area effects (healing and toxic tiles) applied by the arena grid
+ * @dependencies None
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** @brief A heal and/or damage rate applied to every unit standing on a tile
+ */
+struct FTileEffect
+{
+	int Tile;
+	float HealPerSecond;
+	float DamagePerSecond;
+	float TimeLeft;
+
+	FTileEffect(int tile, float heal, float damage, float duration)
+		: Tile(tile), HealPerSecond(heal), DamagePerSecond(damage), TimeLeft(duration){}
+};
+
+/** @brief Stores the combined heal and damage rate of every tile along with a compact list of the tiles that have any.
+ *		Permanent effects (toppers) last until Reset, timed effects (spills) count down and remove themselves
+ */
+class ROBOTGLADIATOR_API FTileAreaEffects
+{
+public:
+	FTileAreaEffects();
+
+	/** @brief Sizes the effects for a new layout and clears them
+	 *  @param {int} numTiles - The number of tiles in the layout
+	 */
+	void Init(int numTiles);
+
+	// Clears every effect
+	void Reset();
+
+	/** @brief Adds an effect to a tile
+	 *  @param {FTileEffect} effect - The effect to add. A TimeLeft of 0 or less never expires
+	 */
+	void AddEffect(const FTileEffect& effect);
+
+	/** @brief Counts down timed effects and removes the ones that ran out
+	 *  @param {float} deltaTime - Time elapsed since the last tick
+	 *  @param {TArray<FTileEffect>&} outExpired - Filled with the effects that were removed
+	 */
+	void Tick(float deltaTime, TArray<FTileEffect>& outExpired);
+
+	// Returns every tile with an effect on it
+	const TArray<int>& GetActiveTiles() const { return mActiveTiles; }
+
+	// Returns the heal rate minus the damage rate of a tile
+	float GetNetRate(int tile) const { return mHealRates.IsValidIndex(tile) ? mHealRates[tile] - mDamageRates[tile] : 0.0f; }
+
+private:
+	// Adds the rates of an effect to its tile, negative scale removes them
+	void ApplyRates(const FTileEffect& effect, float scale);
+
+private:
+	// Combined rates of every tile
+	TArray<float> mHealRates;
+	TArray<float> mDamageRates;
+
+	// How many effects are on each tile and the tiles with at least one
+	TArray<int> mEffectCounts;
+	TArray<int> mActiveTiles;
+
+	TArray<FTileEffect> mTimedEffects;
+};
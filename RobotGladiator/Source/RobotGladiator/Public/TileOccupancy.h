@@ -0,0 +1,84 @@
+/**
+ * @file TileOccupancy.h
+ * @brief Declares the tile occupancy index which tracks which units are standing on which hex
+ * @dependencies BaseUnit.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ABaseUnit;
+
+/** @brief Keeps a compact list of units per tile and the current tile of every unit.
+ *		Units are referred to by a handle that stays valid until the unit is removed
+ */
+class ROBOTGLADIATOR_API FTileOccupancy
+{
+public:
+	FTileOccupancy();
+
+	/** @brief Resizes the index for a new layout. Every unit is kept but taken off the grid
+	 *  @param {int} numTiles - The number of tiles in the new layout
+	 */
+	void ResetTiles(int numTiles);
+
+	/** @brief Adds a unit to the index
+	 *  @param {ABaseUnit*} unit - The unit to add
+	 *  @param {int} tile - The tile the unit starts on, -1 if it is off the grid
+	 *  @return {int} - The handle of the unit
+	 */
+	int AddUnit(ABaseUnit* unit, int tile);
+
+	/** @brief Removes a unit from the index, freeing its handle
+	 *  @param {int} handle - The handle of the unit to remove
+	 */
+	void RemoveUnit(int handle);
+
+	/** @brief Moves a unit onto another tile
+	 *  @param {int} handle - The handle of the unit to move
+	 *  @param {int} tile - The tile the unit is now on, -1 if it left the grid
+	 */
+	void MoveUnit(int handle, int tile);
+
+	// Returns the unit with the given handle, nullptr if the handle is free
+	ABaseUnit* GetUnit(int handle) const { return mUnits.IsValidIndex(handle) ? mUnits[handle] : nullptr; }
+
+	// Returns the tile the unit with the given handle is on
+	int GetUnitTile(int handle) const { return mUnitTiles.IsValidIndex(handle) ? mUnitTiles[handle] : INDEX_NONE; }
+
+	// Returns the handles of the units on a tile
+	const TArray<int>& GetTileUnits(int tile) const { return mTileUnits.IsValidIndex(tile) ? mTileUnits[tile] : mEmpty; }
+
+	// Returns true if any unit is on the tile
+	bool IsTileOccupied(int tile) const { return GetTileUnits(tile).Num() > 0; }
+
+	// Returns one past the highest handle in use, free handles below it return nullptr from GetUnit
+	int GetMaxHandle() const { return mUnits.Num(); }
+
+	int GetNumTiles() const { return mTileUnits.Num(); }
+
+private:
+	// Takes a unit off the list of its current tile
+	void RemoveFromTile(int handle);
+
+	// Places a unit at the end of a tile's list
+	void AddToTile(int handle, int tile);
+
+private:
+	// Handles of the units on each tile
+	TArray<TArray<int>> mTileUnits;
+
+	// Per handle data
+	TArray<ABaseUnit*> mUnits;
+	TArray<int> mUnitTiles;
+	TArray<int> mSlotInTile;
+
+	// Handles that can be reused
+	TArray<int> mFreeHandles;
+
+	TArray<int> mEmpty;
+};
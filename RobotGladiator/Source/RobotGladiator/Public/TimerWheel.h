@@ -0,0 +1,114 @@
+/**
+ * @file TimerWheel.h
+ * @brief Declares a hierarchical timer wheel for gameplay cooldowns
+ * @dependencies None
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Timers are bucketed by the tick they expire on into a few levels of slots. The first level holds the next 64 ticks,
+ * each level after that holds 64 times as many ticks per slot and is moved down a level when the level below wraps.
+ * Adding and cancelling a timer is O(1) no matter how many are running, and advancing only touches the slot for the
+ * current tick. Expired timers are handed back in one batch so the owner can act on all of them at once
+ */
+class ROBOTGLADIATOR_API FTimerWheel
+{
+public:
+	/** @brief Creates an empty timer wheel
+	 *  @param {float} tickLength - Seconds per tick, timers are rounded up to a whole number of ticks
+	 */
+	FTimerWheel(float tickLength = 1.0f / 30.0f);
+
+	/** @brief Starts a timer
+	 *  @param {float} delay - Seconds until the timer expires, always at least one tick
+	 *  @param {int} userData - Handed back when the timer expires
+	 *  @return {uint64} - Handle used to cancel the timer, never 0
+	 */
+	uint64 AddTimer(float delay, int userData);
+
+	/** @brief Stops a timer before it expires
+	 *  @param {uint64} handle - The timer to stop
+	 *  @return {bool} - true if the timer was still running
+	 */
+	bool CancelTimer(uint64 handle);
+
+	/** @brief Changes the data handed back when a timer expires
+	 *  @param {uint64} handle - The timer to change
+	 *  @param {int} userData - The new data
+	 */
+	void SetUserData(uint64 handle, int userData);
+
+	/** @brief Moves time forward and collects every timer that expired
+	 *  @param {float} deltaTime - Seconds elapsed since the last advance
+	 *  @param {TArray<int>&} outExpired - Filled with the user data of the expired timers, in the order they expired
+	 */
+	void Advance(float deltaTime, TArray<int>& outExpired);
+
+	// Stops every timer
+	void Reset();
+
+	// Returns true if the timer hasn't expired or been cancelled
+	bool IsActive(uint64 handle) const { return FindNode(handle) != INDEX_NONE; }
+
+	// Returns the seconds left on a timer, 0 if it isn't running
+	float GetTimeLeft(uint64 handle) const;
+
+	// Returns the number of running timers
+	int GetNumTimers() const { return mNumTimers; }
+
+private:
+	enum
+	{
+		SLOT_BITS = 6,
+		NUM_SLOTS = 1 << SLOT_BITS,
+		SLOT_MASK = NUM_SLOTS - 1,
+		NUM_LEVELS = 3,
+	};
+
+	struct FTimerNode
+	{
+		uint64 ExpireTick;
+		int UserData;
+		uint32 Serial;
+
+		// Neighbours in the slot's list, INDEX_NONE at the ends
+		int Prev;
+		int Next;
+
+		// Index into mSlotHeads, INDEX_NONE while the node is free
+		int Slot;
+	};
+
+	// Returns the node a handle points to, INDEX_NONE if the timer isn't running
+	int FindNode(uint64 handle) const;
+
+	// Puts a node in the slot for its expire tick
+	void Link(int node);
+
+	// Takes a node out of its slot
+	void Unlink(int node);
+
+	// Moves every timer in a slot of a higher level down to where it belongs now
+	void Cascade(int level, int slot);
+
+private:
+	TArray<FTimerNode> mNodes;
+	TArray<int> mFreeNodes;
+
+	// First node of every slot, NUM_SLOTS per level
+	int mSlotHeads[NUM_LEVELS * NUM_SLOTS];
+
+	uint64 mCurrentTick;
+	float mTickLength;
+
+	// Time that hasn't made up a whole tick yet
+	float mAccumulator;
+
+	int mNumTimers;
+};
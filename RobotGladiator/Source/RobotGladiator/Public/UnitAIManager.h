@@ -0,0 +1,183 @@
+/**
+ * @file UnitAIManager.h
+ * @brief Declares the AI manager which updates every gladiator and grunt in one batched pass instead of per actor Tick,
+ *		thinking less often for units that are far away from every player
+ * @dependencies BaseUnit.h, PlayerRegistrySubsystem.h, TimerWheel.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "TimerWheel.h"
+#include "UnitAIManager.generated.h"
+
+class ABaseUnit;
+
+UENUM(BlueprintType)
+enum EAILODTier
+{
+	AI_LOD_NEAR		UMETA(DisplayName = "Near"),		// Thinks every frame
+	AI_LOD_MID		UMETA(DisplayName = "Mid"),			// Thinks at a reduced rate
+	AI_LOD_FAR		UMETA(DisplayName = "Far"),			// Thinks rarely and keeps its target, but still attacks
+
+	NUM_AI_LOD_TIERS UMETA(Hidden)
+};
+
+/**
+ * Stores the AI state of every managed unit in contiguous arrays. Each frame positions are gathered, distances and
+ * cooldowns are updated in one (optionally parallel) pass, and units that are ready to act are told to. Target
+ * acquisition is the expensive decision, so only a few units look for a new target each frame. Cooldowns live in a
+ * timer wheel so units waiting on one cost nothing until it expires.
+ * Units are sorted into LOD tiers by their distance to the closest player, the tier controls how often the unit
+ * thinks and how often its movement component ticks. Tier settings are read from DefaultGame.ini
+ */
+UCLASS(config = Game)
+class ROBOTGLADIATOR_API UUnitAIManager : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UUnitAIManager();
+
+	/** @brief Gets the AI manager for the world an object is in
+	 *  @param {UObject*} worldContextObject - Any object in the world
+	 *  @return {UUnitAIManager*} - The AI manager, or nullptr if the object isn't in a world
+	 */
+	static UUnitAIManager* Get(const UObject* worldContextObject);
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	/** @brief Starts making decisions for a unit
+	 *  @param {ABaseUnit*} unit - The unit to manage
+	 */
+	void RegisterUnit(ABaseUnit* unit);
+
+	/** @brief Stops making decisions for a unit
+	 *  @param {ABaseUnit*} unit - The unit to stop managing
+	 */
+	void UnregisterUnit(ABaseUnit* unit);
+
+	/** @brief Changes a unit's target straight away instead of waiting for its turn to retarget
+	 *  @param {ABaseUnit*} unit - The unit to change
+	 *  @param {AActor*} target - The unit's new target
+	 */
+	void SetTarget(ABaseUnit* unit, AActor* target);
+
+	// Returns the number of managed units
+	int GetNumUnits() const { return mUnits.Num(); }
+
+public:
+	// Units that look for a new target each frame, the rest keep their current target
+	int RetargetsPerFrame;
+
+	// Below this many units the update runs on the game thread only
+	int ParallelThreshold;
+
+	// Units closer than this to a player are in the near tier
+	UPROPERTY(config)
+	float NearDistance;
+
+	// Units farther than this from every player are in the far tier
+	UPROPERTY(config)
+	float FarDistance;
+
+	// A unit has to move this far past a threshold before it changes tier, stops units flickering between tiers
+	UPROPERTY(config)
+	float TierHysteresis;
+
+	// Seconds between decisions for mid and far units, near units decide every frame
+	UPROPERTY(config)
+	float MidDecisionInterval;
+	UPROPERTY(config)
+	float FarDecisionInterval;
+
+	// Movement component tick interval for each tier, 0 ticks every frame
+	UPROPERTY(config)
+	float NearMovementTickInterval;
+	UPROPERTY(config)
+	float MidMovementTickInterval;
+	UPROPERTY(config)
+	float FarMovementTickInterval;
+
+private:
+	// Reads the positions and busy state of every unit and its target
+	void GatherState();
+
+	// Finds new targets for the next few units in line
+	void UpdateTargets();
+
+	// Updates distances and cooldowns and flags the units that are ready to act
+	void UpdateDecisions(float deltaTime);
+
+	// Pushes the new state back to the units and tells the ready ones to act
+	void ApplyDecisions();
+
+	// Removes the units that were unregistered during the update
+	void RemovePendingUnits();
+
+	// Clears the cooldowns that ran out so those units can act this frame
+	void UpdateCooldowns(float deltaTime);
+
+	// Starts a cooldown for a unit, replacing the one it had
+	void StartCooldown(int handle, float cooldown);
+
+	// Finds the best target for a unit
+	AActor* FindTarget(ABaseUnit* unit) const;
+
+	// Works out which tier a unit belongs in from its distance to the closest player
+	EAILODTier GetTierForDistance(float distance, EAILODTier currentTier) const;
+
+	// Returns the seconds between decisions and the movement tick interval for a tier
+	float GetDecisionInterval(EAILODTier tier) const;
+	float GetMovementTickInterval(EAILODTier tier) const;
+
+private:
+	enum EAIFlags : uint8
+	{
+		AI_NONE = 0,
+		AI_BUSY = 1 << 0,			// The unit is mid-action
+		AI_HAS_TARGET = 1 << 1,
+		AI_READY = 1 << 2,			// The unit should act this frame
+		AI_THINK = 1 << 3,			// The unit's decision timer ran out this frame
+	};
+
+	// Per unit state, all indexed by the unit's AI handle
+	UPROPERTY()
+	TArray<ABaseUnit*> mUnits;
+	UPROPERTY()
+	TArray<AActor*> mTargets;
+	TArray<FVector> mPositions;
+	TArray<FVector> mTargetPositions;
+	TArray<float> mDistances;
+	TArray<uint64> mCooldownTimers;		// 0 when the unit is off cooldown
+	TArray<uint8> mFlags;
+	TArray<float> mPlayerDistances;
+	TArray<float> mDecisionTimers;
+	TArray<uint8> mTiers;
+
+	// Player locations gathered once per frame for the tier update
+	TArray<FVector> mPlayerPositions;
+
+	// Where the time-sliced target search picks up next frame
+	int mRetargetCursor;
+
+	// Cooldown timers of every unit, the user data is the unit's AI handle
+	FTimerWheel mCooldownWheel;
+	TArray<int> mExpiredCooldowns;
+
+	// Set while the arrays are being walked so removals are deferred
+	bool mIsUpdating;
+	TArray<int> mPendingRemovals;
+};
@@ -0,0 +1,28 @@
+/**
+ * @file UnitMovementComponent.h
+ * @brief Declares the movement component every unit uses, which scales the unit's own walk speed by its status effects
+ * @dependencies CharacterMovementComponent.h, BaseUnit.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "UnitMovementComponent.generated.h"
+
+/**
+ * MaxWalkSpeed stays whatever the unit sets it to (base speed, sprinting, lock on, stat bonuses) and the unit's
+ * replicated speed scale is applied on top when the max speed is read. The scale is replicated, so owning clients
+ * predict with the same speed the server moves them at
+ */
+UCLASS()
+class ROBOTGLADIATOR_API UUnitMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	virtual float GetMaxSpeed() const override;
+};
@@ -0,0 +1,98 @@
+/**
+ * @file UnitPoolSubsystem.h
+ * @brief Declares a world subsystem that recycles dead enemies instead of destroying and respawning them
+ * @dependencies WorldSubsystem.h, BaseUnit.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UnitPoolSubsystem.generated.h"
+
+class ABaseUnit;
+
+USTRUCT()
+/** @brief The inactive units of one class waiting to be reused
+ */
+struct FUnitPoolList
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<ABaseUnit*> Units;
+};
+
+/**
+ * Dead units are hidden, lose their collision, stop ticking and have their AI paused, then wait in a pool for their
+ * class. Acquiring a unit reuses a pooled one if there is one, so the capsule, movement component, mesh and anim
+ * instance are only built once
+ */
+UCLASS()
+class ROBOTGLADIATOR_API UUnitPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UUnitPoolSubsystem();
+
+	/** @brief Gets the unit pool for the world an object is in
+	 *  @param {UObject*} worldContextObject - Any object in the world
+	 *  @return {UUnitPoolSubsystem*} - The unit pool, or nullptr if the object isn't in a world
+	 */
+	static UUnitPoolSubsystem* Get(const UObject* worldContextObject);
+
+	virtual void Deinitialize() override;
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Gets a unit ready to fight, reusing a pooled one if possible
+	 *  @param {TSubclassOf<ABaseUnit>} unitClass - The class of unit to get
+	 *  @param {FVector} location - Where to put the unit
+	 *  @param {FRotator} rotation - Which way the unit faces
+	 *  @param {AActor*} owner - The owner of the unit
+	 *  @param {ESpawnActorCollisionHandlingMethod} collisionHandling - What to do if the unit would collide there, as when spawning
+	 *  @return {ABaseUnit*} - The unit, nullptr if it couldn't be spawned or placed
+	 */
+	ABaseUnit* AcquireUnit(TSubclassOf<ABaseUnit> unitClass, FVector location, FRotator rotation, AActor* owner = nullptr,
+		ESpawnActorCollisionHandlingMethod collisionHandling = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Takes a unit out of play and keeps it for reuse
+	 *  @param {ABaseUnit*} unit - The unit to release
+	 */
+	void ReleaseUnit(ABaseUnit* unit);
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Spawns units ahead of time so the first wave doesn't pay for building them
+	 *  @param {TSubclassOf<ABaseUnit>} unitClass - The class of unit to spawn
+	 *  @param {int} count - How many units the pool should hold
+	 */
+	void PrewarmPool(TSubclassOf<ABaseUnit> unitClass, int count);
+
+	// Returns the number of inactive units of a class in the pool
+	int GetNumPooled(TSubclassOf<ABaseUnit> unitClass) const;
+
+public:
+	// Units released past this many per class are destroyed instead
+	int MaxPooledPerClass;
+
+	// Where prewarmed units are spawned, out of sight below the arena, and the gap between each of them
+	FVector PrewarmLocation;
+	float PrewarmSpacing;
+
+private:
+	/** @brief Moves a location the way spawning would if a unit placed there collides with something
+	 *  @param {ABaseUnit*} unit - The unit being placed, its collision has to be on
+	 *  @param {ESpawnActorCollisionHandlingMethod} collisionHandling - What to do if the unit collides
+	 *  @param {FVector} location - The location to place the unit, adjusted in place
+	 *  @param {FRotator} rotation - Which way the unit faces
+	 *  @return {bool} - False if the unit shouldn't be placed at all
+	 */
+	bool AdjustPlacement(ABaseUnit* unit, ESpawnActorCollisionHandlingMethod collisionHandling, FVector& location, FRotator rotation) const;
+
+	UPROPERTY()
+	TMap<UClass*, FUnitPoolList> mPools;
+};
@@ -0,0 +1,83 @@
+/**
+ * @file UnitSignificanceSubsystem.h
+ * @brief Declares a world subsystem that rates how much each unit matters to the local player and feeds that to the
+ *		animation budget allocator
+ * @dependencies WorldSubsystem.h, Tickable.h, IAnimationBudgetAllocator.h, PlayerRegistrySubsystem.h, ArenaGrid.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "UnitSignificanceSubsystem.generated.h"
+
+class ABaseUnit;
+class AArenaGrid;
+
+/**
+ * Every unit's mesh is a budgeted skeletal mesh. Each frame this rates the units on the arena by their distance to
+ * the local players, whether they were rendered recently and whether they are after a local player, and passes the
+ * rating to the animation budget allocator. The allocator then picks which meshes tick, which are interpolated and
+ * which skip frames so that animation stays inside a fixed number of milliseconds per frame.
+ * Nothing is done on a dedicated server, which never animates
+ */
+UCLASS(config = Game)
+class ROBOTGLADIATOR_API UUnitSignificanceSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UUnitSignificanceSubsystem();
+
+	/** @brief Gets the significance subsystem for the world an object is in
+	 *  @param {UObject*} worldContextObject - Any object in the world
+	 *  @return {UUnitSignificanceSubsystem*} - The subsystem, or nullptr if the object isn't in a world
+	 */
+	static UUnitSignificanceSubsystem* Get(const UObject* worldContextObject);
+
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	/** @brief Rates how much a unit matters to the local players
+	 *  @param {ABaseUnit*} unit - The unit to rate
+	 *  @return {float} - 1 for units that must animate every frame down to 0 for units nobody can see
+	 */
+	float CalculateSignificance(const ABaseUnit* unit) const;
+
+public:
+	// Milliseconds per frame all unit animation has to fit in
+	UPROPERTY(config)
+	float AnimationBudgetMs;
+
+	// Distance at which a visible unit's significance has halved
+	UPROPERTY(config)
+	float HalfSignificanceDistance;
+
+	// Scales the significance of units that weren't rendered last frame
+	UPROPERTY(config)
+	float OffscreenScale;
+
+private:
+	// Turns the allocator on with our budget the first time we tick
+	void SetupBudgetAllocator();
+
+private:
+	UPROPERTY()
+	AArenaGrid* mpArena;
+
+	// Locations of the locally controlled players, and the players themselves for target checks
+	TArray<FVector> mViewLocations;
+	TArray<AActor*> mLocalPlayers;
+
+	bool mIsAllocatorSetUp;
+};
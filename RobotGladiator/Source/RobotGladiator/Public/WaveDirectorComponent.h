@@ -0,0 +1,138 @@
+/**
+ * @file WaveDirectorComponent.h
+ * @brief Declares the wave director, which feeds grunts into the arena over the course of a round
+ * @dependencies ActorComponent.h, ArenaGrid.h, TileOccupancy.h, HexFlowField.h, UnitPoolSubsystem.h
+ *
+ * @author agent
+ * @credits
+ **/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "WaveDirectorComponent.generated.h"
+
+class AArenaGrid;
+class ABaseUnit;
+
+/**
+ * Grunts are asked for in waves (and by the grunt tiles rolled for a layout) but only a few are spawned per frame,
+ * so a wave never lands in a single hitch. Spawn tiles are chosen from the arena's own data: the flow field says how
+ * many steps a tile is from the nearest player and whether one can be reached at all, the occupancy index says if
+ * anything is already standing there and the influence map says if it is hazardous. Units come from the unit pool
+ * through the arena. Only runs on the server
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class ROBOTGLADIATOR_API UWaveDirectorComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UWaveDirectorComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Starts sending waves, the first one straight away
+	 */
+	void StartWaves();
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Stops sending waves, grunts already asked for are still spawned
+	 */
+	void StopWaves();
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Stops waves and forgets every grunt that was asked for or spawned
+	 */
+	void Reset();
+
+	UFUNCTION(BlueprintCallable)
+	/** @brief Asks for grunts to be spawned over the next few frames
+	 *  @param {int} count - How many grunts to add
+	 */
+	void QueueSpawns(int count);
+
+	UFUNCTION(BlueprintPure)
+	/** @brief Gets how many grunts are waiting to be spawned
+	 *  @return {int} - The number of grunts asked for but not spawned yet
+	 */
+	int GetNumPending() const { return mPendingSpawns; }
+
+	UFUNCTION(BlueprintPure)
+	/** @brief Gets how many grunts spawned by the director are still alive
+	 *  @return {int} - The number of live grunts
+	 */
+	int GetNumAlive() const { return mAlive.Num(); }
+
+	UFUNCTION(BlueprintPure)
+	/** @brief Gets the number of waves sent since StartWaves
+	 *  @return {int} - The wave count
+	 */
+	int GetWaveNumber() const { return mWaveNumber; }
+
+	// Returns true while waves are being sent
+	bool IsRunning() const { return mIsRunning; }
+
+public:
+	// Seconds between waves
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Waves)
+	float WaveInterval;
+
+	// Grunts in the first wave, and how many more each wave after it brings
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Waves)
+	int GruntsPerWave;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Waves)
+	int GruntsAddedPerWave;
+
+	// Grunts from the director alive at once, waves wait for room under this
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Waves)
+	int MaxAliveGrunts;
+
+	// Most grunts spawned in one frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Waves)
+	int MaxSpawnsPerFrame;
+
+	// Grunts spawn between this many and MaxPlayerSteps flow field steps from the nearest player
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Waves)
+	int MinPlayerSteps;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Waves)
+	int MaxPlayerSteps;
+
+	// Grunt tiles rolled for a layout are handed to the director instead of all spawning when the layout loads
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Waves)
+	bool SpreadModifierGrunts;
+
+protected:
+	virtual void BeginPlay() override;
+
+	// Sends the next wave if it is due
+	void UpdateWaves(float deltaTime);
+
+	// Spawns as many pending grunts as the budget allows
+	void SpawnPending();
+
+	// Finds every tile a grunt could spawn on right now
+	void GatherSpawnTiles();
+
+	// Drops grunts that died or went back to the pool
+	void PruneAlive();
+
+private:
+	UPROPERTY()
+	AArenaGrid* mpArena;
+
+	// Grunts that are alive, only compared against the pool state so weak pointers are enough
+	TArray<TWeakObjectPtr<ABaseUnit>> mAlive;
+
+	// Reused each time spawn tiles are gathered
+	TArray<int> mSpawnTiles;
+
+	FRandomStream mRand;
+
+	float mWaveTimer;
+	int mWaveNumber;
+	int mPendingSpawns;
+	bool mIsRunning;
+};
@@ -67,6 +67,9 @@ ARobotGladiatorCharacter::ARobotGladiatorCharacter()
 
 	IsLockedOnEnemy = false;
 
+	// Players are the threat the enemy AI reacts to
+	mIsPlayerUnit = true;
+
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named MyCharacter (to avoid direct content references in C++)
 }